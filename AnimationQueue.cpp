@@ -0,0 +1,79 @@
+#include "AnimationQueue.h"
+#include <cmath>
+#include <iostream>
+
+void AnimationQueue::push(int axis, int layer, float angle) {
+    if (!queue.empty() && queue.back().axis == axis && queue.back().layer == layer) {
+        // Merge with the previous turn of the layer, the short way round
+        float merged = std::fmod(queue.back().angle + angle, 360.0f);
+        if (merged > 180.0f)
+            merged -= 360.0f;
+        else if (merged <= -180.0f)
+            merged += 360.0f;
+        if (merged == 0.0f)
+            queue.pop_back();
+        else
+            queue.back().angle = merged;
+        return;
+    }
+    queue.push_back({axis, layer, angle});
+}
+
+// Take the next turn the cube can make; a turn about another axis than a layer left mid-turn is dropped
+bool AnimationQueue::start(const RubiksCube& cube) {
+    while (!queue.empty()) {
+        Turn next = queue.front();
+        queue.pop_front();
+        glm::vec3 axis(0.0f);
+        axis[next.axis] = 1.0f;
+        if (glm::dot(axis, cube.locks) != 0.0f) {
+            std::cout << "Turn skipped, another axis is mid-turn" << std::endl;
+            continue;
+        }
+        current = next;
+        turned = 0.0f;
+        animating = true;
+        return true;
+    }
+    return false;
+}
+
+void AnimationQueue::turnBy(RubiksCube& cube, float degrees, bool last) {
+    // The whole turn is recorded once, with its last step
+    cube.remoteLayerRotation(current.axis, current.layer, degrees, last ? current.angle : 0.0f);
+    turned += degrees;
+    if (last)
+        animating = false;
+}
+
+// Duration of the current turn: shorter the more turns are waiting behind it
+double AnimationQueue::currentSeconds() const {
+    const size_t backlog = queue.size();
+    return backlog > FAST_BACKLOG ? turnSeconds * FAST_BACKLOG / backlog : turnSeconds;
+}
+
+void AnimationQueue::update(RubiksCube& cube, double seconds) {
+    while (queue.size() > MAX_BACKLOG && (animating || start(cube)))
+        turnBy(cube, current.angle - turned, true);
+    while (animating || start(cube)) {
+        const float remaining = current.angle - turned;
+        const double duration = currentSeconds();
+        const double needed = duration * std::abs(remaining / current.angle);
+        if (needed > seconds) {
+            turnBy(cube, float(current.angle * seconds / duration), false);
+            return;
+        }
+        seconds -= needed;
+        turnBy(cube, remaining, true);
+    }
+}
+
+void AnimationQueue::finish(RubiksCube& cube) {
+    while (animating || start(cube))
+        turnBy(cube, current.angle - turned, true);
+}
+
+void AnimationQueue::clear() {
+    queue.clear();
+    animating = false;
+}
@@ -0,0 +1,52 @@
+#ifndef ANIMATIONQUEUE_H
+#define ANIMATIONQUEUE_H
+
+#include <cstddef>
+#include <deque>
+#include "RubiksCube.h"
+
+// Time-based playback of layer turns, driven from the frame loop. push() queues a turn and returns
+// at once; update() moves the turn in progress on by the time elapsed since the last frame and
+// starts the next ones as turns end. Nothing here sleeps or renders, so input keeps flowing and a
+// frame only pays for the turning it shows.
+//
+// When turns pile up (a long solution, a held key) the backlog is worked off faster: a turn of the
+// layer the last queued turn turns is merged into it, and dropped if the two cancel; turns get
+// shorter in proportion to the backlog beyond FAST_BACKLOG; and past MAX_BACKLOG the oldest turns
+// are made at once, without animating. A turn duration of 0 makes every turn at once.
+class AnimationQueue {
+public:
+    static constexpr double DEFAULT_TURN_SECONDS = 0.3;
+    static const size_t FAST_BACKLOG = 4;
+    static const size_t MAX_BACKLOG = 64;
+
+    struct Turn {
+        int axis;
+        int layer;
+        float angle; // degrees about the positive axis
+    };
+
+    void push(int axis, int layer, float angle);
+    // Advance the animation by seconds; queued turns about a locked axis are dropped when they come up
+    void update(RubiksCube& cube, double seconds);
+    void finish(RubiksCube& cube); // make the rest of every turn now
+    void clear();                  // forget every turn, leaving the cube as it is (before a reset)
+
+    void setTurnSeconds(double seconds) { turnSeconds = seconds > 0.0 ? seconds : 0.0; }
+    double getTurnSeconds() const { return turnSeconds; }
+    bool busy() const { return animating || !queue.empty(); }
+    size_t size() const { return queue.size() + (animating ? 1 : 0); } // including the turn in progress
+
+private:
+    bool start(const RubiksCube& cube);
+    void turnBy(RubiksCube& cube, float degrees, bool last);
+    double currentSeconds() const;
+
+    std::deque<Turn> queue;
+    Turn current = {0, 0, 0.0f};
+    float turned = 0.0f; // degrees of the current turn made so far
+    bool animating = false;
+    double turnSeconds = DEFAULT_TURN_SECONDS;
+};
+
+#endif // ANIMATIONQUEUE_H
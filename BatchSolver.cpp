@@ -0,0 +1,213 @@
+// Headless batch solver. Reads one scramble per line (a move sequence in standard notation, see
+// Notation.h) from a file or stdin, solves them on every core with the two-phase solver and
+// writes one tab separated line per scramble, in input order:
+//   <line number>  <solution>  <solution length>  <solve time in microseconds>
+// or <line number>  error: <message>  for lines that do not parse or cannot be solved.
+// Blank lines and lines starting with # are skipped. A summary goes to stderr.
+// With -r, no scrambles are read: the input is that many uniformly random states of seed -s
+// (RandomState.h), numbered from 1 in place of line numbers, which makes a reproducible load test.
+// Solutions go through a SolutionCache of -c megabytes (0 turns it off), so repeated scrambles and
+// their rotations, mirror images and inverses are only solved once.
+//
+//   BatchSolver [-j threads] [-b batch size] [-m max length] [-t table file] [-c cache MB]
+//               [-r random count] [-s seed] [scramble file]
+//
+// At most two batches are in memory: the next batch is read while the current one is being
+// solved, and a finished batch is written while the following one is being solved.
+// Only the cube model and solver sources are linked, no GLFW or GLAD:
+//   BatchSolver.cpp Notation.cpp Solver.cpp SolverTables.cpp PruneTable.cpp TableFile.cpp
+//   CubeCoordinates.cpp CubeState.cpp RubiksCube.cpp SlotIndex.cpp MoveLog.cpp WorkStealingPool.cpp
+//   CubeSymmetry.cpp SolutionCache.cpp RandomState.cpp CubieArrays.cpp
+#include "Notation.h"
+#include "RandomState.h"
+#include "SolutionCache.h"
+#include "Solver.h"
+#include "SolverTables.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    int threads = 0;
+    size_t batchSize = 4096;
+    int maxLength = Solver::DEFAULT_MAX_LENGTH;
+    std::string tablePath = SolverTables::DEFAULT_PATH;
+    size_t cacheMegabytes = SolutionCache::DEFAULT_BUDGET >> 20;
+    std::string inputPath; // empty for stdin
+    long long randomCount = 0; // random states instead of input when above 0
+    uint64_t seed = 1;
+};
+
+struct Item {
+    long long line;
+    std::string scramble; // empty for a random state
+    CubeState state;      // the random state
+    std::vector<int> solution;
+    std::string error; // empty when solved
+    double micros;
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-j" && hasValue)
+            options.threads = std::atoi(argv[++i]);
+        else if (arg == "-b" && hasValue)
+            options.batchSize = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        else if (arg == "-m" && hasValue)
+            options.maxLength = std::atoi(argv[++i]);
+        else if (arg == "-t" && hasValue)
+            options.tablePath = argv[++i];
+        else if (arg == "-c" && hasValue)
+            options.cacheMegabytes = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        else if (arg == "-r" && hasValue)
+            options.randomCount = std::max(0LL, std::atoll(argv[++i]));
+        else if (arg == "-s" && hasValue)
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (!arg.empty() && arg[0] != '-' && options.inputPath.empty())
+            options.inputPath = arg;
+        else
+            return false;
+    }
+    return true;
+}
+
+// Fill batch with up to batchSize scrambles, reusing its strings
+void readBatch(std::istream& in, long long& lineNumber, size_t batchSize, std::vector<Item>& batch) {
+    size_t count = 0;
+    batch.resize(batchSize);
+    while (count < batchSize && std::getline(in, batch[count].scramble)) {
+        lineNumber++;
+        std::string& scramble = batch[count].scramble;
+        if (!scramble.empty() && scramble.back() == '\r')
+            scramble.pop_back();
+        size_t start = scramble.find_first_not_of(" \t");
+        if (start == std::string::npos || scramble[start] == '#')
+            continue;
+        batch[count++].line = lineNumber;
+    }
+    batch.resize(count);
+}
+
+// The next up to batchSize of count random states
+void randomBatch(uint64_t seed, long long count, long long& generated, size_t batchSize, std::vector<Item>& batch) {
+    const size_t size = static_cast<size_t>(std::min<long long>(count - generated, batchSize));
+    batch.resize(size);
+    for (Item& item : batch) {
+        item.line = ++generated;
+        item.scramble.clear();
+        item.state = randomState(seed, uint64_t(item.line - 1));
+    }
+}
+
+void solveItem(const Solver& solver, SolutionCache* cache, int maxLength, Item& item) {
+    auto start = std::chrono::steady_clock::now();
+    item.error.clear();
+    item.solution.clear();
+    std::vector<int> scramble;
+    if (item.scramble.empty() || parseMoves(item.scramble, scramble, item.error)) {
+        CubeState state = item.state;
+        if (!item.scramble.empty()) {
+            state = CubeState::solved();
+            for (int move : scramble)
+                state.applyMove(move);
+        }
+        const bool cached = cache && cache->lookup(state, item.solution) && int(item.solution.size()) <= maxLength;
+        if (!cached && !solver.solve(state, item.solution, maxLength))
+            item.error = "no solution of at most " + std::to_string(maxLength) + " moves";
+        else if (!cached && cache)
+            cache->insert(state, item.solution);
+    }
+    item.micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " [-j threads] [-b batch size] [-m max length] [-t table file] [-c cache MB]"
+                  << " [-r random count] [-s seed] [scramble file]" << std::endl;
+        return 2;
+    }
+    std::ifstream file;
+    if (!options.inputPath.empty() && options.randomCount == 0) {
+        file.open(options.inputPath);
+        if (!file) {
+            std::cerr << "cannot open " << options.inputPath << std::endl;
+            return 1;
+        }
+    }
+    std::istream& in = options.inputPath.empty() ? std::cin : file;
+    std::ios::sync_with_stdio(false);
+
+    auto start = std::chrono::steady_clock::now();
+    SolverTables tables(options.tablePath);
+    Solver solver(tables);
+    WorkStealingPool pool(options.threads);
+    std::unique_ptr<SolutionCache> cache;
+    if (options.cacheMegabytes > 0)
+        cache = std::make_unique<SolutionCache>(options.cacheMegabytes << 20);
+    std::cerr << "tables ready in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+              << " s, solving on " << pool.threadCount() << " threads" << std::endl;
+
+    auto submit = [&](std::vector<Item>& batch) {
+        for (Item& item : batch)
+            pool.submit([&solver, &cache, &options, &item] { solveItem(solver, cache.get(), options.maxLength, item); });
+    };
+    long long lineNumber = 0, solved = 0, failed = 0, totalMoves = 0;
+    auto write = [&](const std::vector<Item>& batch) {
+        for (const Item& item : batch) {
+            std::cout << item.line << '\t';
+            if (item.error.empty()) {
+                std::cout << formatMoves(item.solution) << '\t' << item.solution.size() << '\t' << item.micros << '\n';
+                solved++;
+                totalMoves += item.solution.size();
+            } else {
+                std::cout << "error: " << item.error << '\n';
+                failed++;
+            }
+        }
+        std::cout.flush();
+    };
+
+    start = std::chrono::steady_clock::now();
+    std::vector<Item> current, next;
+    auto fetch = [&](std::vector<Item>& batch) {
+        if (options.randomCount > 0)
+            randomBatch(options.seed, options.randomCount, lineNumber, options.batchSize, batch);
+        else
+            readBatch(in, lineNumber, options.batchSize, batch);
+    };
+    fetch(current);
+    submit(current);
+    while (!current.empty()) {
+        fetch(next);
+        pool.wait();
+        submit(next);
+        write(current);
+        current.swap(next);
+    }
+    pool.wait();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << solved << " solved, " << failed << " failed in " << seconds << " s ("
+              << (solved + failed) / seconds << " scrambles/s";
+    if (solved > 0)
+        std::cerr << ", " << double(totalMoves) / solved << " moves on average";
+    if (cache) {
+        SolutionCache::Stats stats = cache->stats();
+        std::cerr << ", " << stats.hits << " cache hits";
+    }
+    std::cerr << ")" << std::endl;
+    return failed > 0 ? 1 : 0;
+}
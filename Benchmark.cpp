@@ -0,0 +1,749 @@
+// Headless micro-benchmarks for the cube model. Run with no arguments for every benchmark,
+// or pass benchmark names to run a subset.
+#include "RubiksCube.h"
+#include "CubeState.h"
+#include "CubeSymmetry.h"
+#include "SlotIndex.h"
+#include "Solver.h"
+#include "OptimalSolver.h"
+#include "PatternDatabase.h"
+#include "Notation.h"
+#include "PruneTable.h"
+#include "RandomState.h"
+#include "WorkStealingPool.h"
+#include "AnimationQueue.h"
+#include "SolutionCache.h"
+#include "RayPicker.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// Run op(i) for i in [0, iterations) and return nanoseconds per call
+template <typename Op>
+double nsPerOp(long long iterations, Op op) {
+    auto start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < iterations; i++)
+        op(i);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+void report(const std::string& name, double ns, long long checksum) {
+    std::cout << "  " << name << ": " << ns << " ns/op (checksum " << checksum << ")" << std::endl;
+}
+
+// The scan RubiksCube used before the slot index: every cubie, float epsilon test, fresh vector
+std::vector<int> scanFaceIds(const RubiksCube& cube, int face) {
+    std::vector<int> faceIds;
+    const float epsilon = 0.5f;
+    for (const Cube& cubie : cube.getCubes()) {
+        float coordinate = cube.cubiePosition(cubie)[face / 2];
+        bool positive = face == 0 || face == 2 || face == 5;
+        if (positive ? coordinate > epsilon : coordinate < -epsilon)
+            faceIds.push_back(cubie.id);
+    }
+    return faceIds;
+}
+
+void benchFaceTurns() {
+    std::cout << "Face turns" << std::endl;
+    const long long iterations = 10000000;
+    const glm::vec3 axes[3] = {glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)};
+    long long checksum = 0;
+
+    // Precomputed move list so the loops below do not pay for divisions
+    int moves[1024];
+    for (int i = 0; i < 1024; i++)
+        moves[i] = (i * 7 + i / 18) % NUM_MOVES;
+
+    RubiksCube cube;
+    double ns = nsPerOp(iterations / 10, [&](long long i) {
+        checksum += scanFaceIds(cube, int(i % NUM_FACES)).size();
+    });
+    report("findFaceIds scan", ns, checksum);
+
+    SlotIndex slots;
+    checksum = 0;
+    ns = nsPerOp(iterations, [&](long long i) {
+        checksum += slots.faceCubies(moveFace(moves[i & 1023]))[0];
+    });
+    report("slot index face lookup", ns, checksum);
+
+    ns = nsPerOp(iterations, [&](long long i) {
+        int move = moves[i & 1023];
+        slots.turnFace(moveFace(move), moveQuarterTurns(move));
+    });
+    report("slot index turn", ns, slots.cubieAt(0));
+
+    CubeState state = CubeState::solved();
+    ns = nsPerOp(iterations, [&](long long i) {
+        state.applyMove(moves[i & 1023]);
+    });
+    report("CubeState::applyMove", ns, static_cast<long long>(state.edges));
+
+    ns = nsPerOp(iterations / 10, [&](long long i) {
+        int move = moves[i & 1023];
+        cube.rotateFace(moveFace(move), axes[moveAxis(move)], 90.0f * moveQuarterTurns(move));
+    });
+    report("RubiksCube::rotateFace", ns, static_cast<long long>(cube.getCubes()[0].slot));
+}
+
+// Turn cost should follow the layer's cubie count, size^2 for an outer layer and 4(size-1) for an
+// inner one, not the size^3 of the whole cube
+void benchLayerTurns() {
+    std::cout << "Layer turns by cube size" << std::endl;
+    for (int size : {2, 3, 5, 9, 17, 33, 65}) {
+        RubiksCube cube(size);
+        const long long iterations = 4000000 / size;
+        auto turnLayers = [&](bool outer) {
+            return nsPerOp(iterations, [&](long long i) {
+                int layer = outer ? int(i / 3 % 2) * (size - 1) : 1 + int(i / 3 % (size - 2));
+                cube.rotateLayer(int(i % 3), layer, 90.0f);
+            });
+        };
+        double outer = turnLayers(true);
+        std::cout << "  " << size << "x" << size << "x" << size << " (" << cube.getCubes().size() << " cubies): outer layer "
+                  << outer << " ns, " << outer / (size * size) << " ns/cubie";
+        if (size > 2) {
+            double inner = turnLayers(false);
+            std::cout << "; inner layer " << inner << " ns, " << inner / (4 * (size - 1)) << " ns/cubie";
+        }
+        std::cout << std::endl;
+    }
+}
+
+// Every cubie's model matrix for one frame, with an outer layer a third of the way through a turn:
+// a cubieMatrix call per cubie, as the renderer used to, against the bulk CubieArrays kernel
+void benchCubieMatrices() {
+    std::cout << "Cubie matrices by cube size" << std::endl;
+    const glm::mat4 parent = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -10.0f));
+    for (int size : {3, 9, 17, 33, 65}) {
+        RubiksCube cube(size);
+        cube.mixCube(uint64_t(size));
+        cube.rotateLayer(1, size - 1, 30.0f);
+        const size_t count = cube.getCubes().size();
+        std::vector<glm::mat4> single(count);
+        AlignedVector<glm::mat4> bulk(count);
+        const long long frames = std::max(20LL, 20000000LL / (long long)count);
+        double perCubie = nsPerOp(frames, [&](long long) {
+            for (const Cube& cubie : cube.getCubes())
+                single[cubie.id] = parent * cube.cubieMatrix(cubie);
+        });
+        double kernel = nsPerOp(frames, [&](long long) { cube.cubieMatrices(parent, bulk.data()); });
+        float error = 0.0f;
+        for (size_t i = 0; i < count; i++)
+            for (int column = 0; column < 4; column++)
+                for (int row = 0; row < 4; row++)
+                    error = std::max(error, std::abs(single[i][column][row] - bulk[i][column][row]));
+        std::cout << "  " << size << "x" << size << "x" << size << " (" << count << " cubies): cubieMatrix "
+                  << perCubie / count << " ns/cubie, cubieMatrices " << kernel / count << " ns/cubie ("
+                  << perCubie / kernel << "x), largest difference " << error << std::endl;
+    }
+}
+
+// The picking pickCubie replaces: an oriented box test against every cubie
+int pickEveryCubie(const RubiksCube& cube, const glm::mat4& model, const Ray& ray) {
+    int nearest = -1;
+    float best = 1e30f;
+    for (const Cube& cubie : cube.getCubes()) {
+        const glm::mat4 toCubie = glm::inverse(model * cube.cubieMatrix(cubie));
+        const glm::vec3 origin = glm::vec3(toCubie * glm::vec4(ray.origin, 1.0f));
+        const glm::vec3 direction = glm::vec3(toCubie * glm::vec4(ray.direction, 0.0f));
+        float tNear = -1e30f, tFar = 1e30f;
+        for (int axis = 0; axis < 3; axis++) {
+            float t0 = (-0.5f - origin[axis]) / direction[axis], t1 = (0.5f - origin[axis]) / direction[axis];
+            tNear = std::max(tNear, std::min(t0, t1));
+            tFar = std::min(tFar, std::max(t0, t1));
+        }
+        if (tNear <= tFar && tFar >= 0.0f && tNear < best) {
+            best = tNear;
+            nearest = cubie.id;
+        }
+    }
+    return nearest;
+}
+
+// Rays through a grid of pixels of an 800 x 800 view from above and to the right, by the
+// grid walk and by testing every cubie, on a settled cube and with two layers mid-turn
+void benchRayPicking() {
+    std::cout << "Ray picking by cube size" << std::endl;
+    const glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -10.0f));
+    const glm::mat4 view = glm::lookAt(glm::vec3(3.0f, 4.0f, 0.0f), glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+    std::vector<Ray> rays;
+    for (int y = 5; y < 800; y += 10)
+        for (int x = 5; x < 800; x += 10)
+            rays.push_back(pickingRay(view, projection, 800, 800, x + 0.5, y + 0.5));
+    for (int size : {3, 17, 65}) {
+        for (bool turning : {false, true}) {
+            RubiksCube cube(size);
+            cube.mixCube(uint64_t(size));
+            if (turning) {
+                cube.remoteLayerRotation(1, size - 1, 30.0f, 0.0f);
+                cube.remoteLayerRotation(1, 0, -20.0f, 0.0f);
+            }
+            std::vector<int> walked(rays.size()), tested(rays.size());
+            long long hits = 0;
+            const long long repeats = size > 17 ? 1 : 10;
+            double walk = nsPerOp(repeats * (long long)rays.size(), [&](long long i) {
+                RayHit hit;
+                walked[i % rays.size()] = pickCubie(cube, model, rays[i % rays.size()], hit) ? hit.id : -1;
+                hits += hit.id >= 0;
+            });
+            const size_t stride = size > 17 ? 16 : 1; // testing every cubie is slow on big cubes
+            double every = nsPerOp((long long)(rays.size() / stride), [&](long long i) {
+                tested[i * stride] = pickEveryCubie(cube, model, rays[i * stride]);
+            });
+            int differ = 0;
+            for (size_t i = 0; i < rays.size(); i += stride)
+                differ += walked[i] != tested[i];
+            std::cout << "  " << size << "x" << size << "x" << size << (turning ? " mid-turn" : " settled ") << ": grid walk "
+                      << walk / 1000.0 << " us/pick, every cubie " << every / 1000.0 << " us/pick (" << every / walk
+                      << "x), " << differ << " of " << rays.size() / stride << " picks differ (hits " << hits << ")" << std::endl;
+        }
+    }
+}
+
+// Playback of a long queue at 60 frames per second: how many frames it takes with the backlog
+// speed-up and what the worst frame costs, then playback with every turn made at once
+void benchAnimation() {
+    std::cout << "Animation queue" << std::endl;
+    const int turns = 2000;
+    const double frame = 1.0 / 60.0;
+    std::mt19937 random(3);
+    RubiksCube cube;
+    AnimationQueue animations;
+    for (int i = 0; i < turns; i++)
+        animations.push(int(random() % 3), random() % 2 ? 2 : 0, 90.0f * (1 + random() % 3));
+    const size_t queued = animations.size();
+    int frames = 0;
+    double worst = 0.0;
+    while (animations.busy()) {
+        auto start = std::chrono::steady_clock::now();
+        animations.update(cube, frame);
+        worst = std::max(worst, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        frames++;
+    }
+    std::cout << "  " << queued << " turns after merging, played in " << frames << " frames (" << frames * frame
+              << " s at 60 fps, " << queued * AnimationQueue::DEFAULT_TURN_SECONDS << " s without speed-up), worst frame "
+              << worst << " ms" << std::endl;
+
+    animations.setTurnSeconds(0.0);
+    const long long instantTurns = 1000000;
+    for (long long i = 0; i < instantTurns; i++)
+        animations.push(int(i % 3), int(i / 3 % 2) * 2, 90.0f);
+    double ns = nsPerOp(1, [&](long long) { animations.update(cube, frame); }) / instantTurns;
+    report("instant playback per turn", ns, static_cast<long long>(cube.getCubes()[0].slot));
+}
+
+void benchNotation() {
+    std::cout << "Notation" << std::endl;
+    const char* tokens[] = {"R", "U'", "F2", "L", "D'", "B2", "r", "M'", "E2", "Rw", "S", "x'", "y2", "U", "R'", "F'"};
+    std::mt19937 random(8);
+    std::string text;
+    while (text.size() < (64 << 20)) {
+        text += tokens[random() % 16];
+        text += ' ';
+    }
+
+    // Fed in 64 KiB chunks, the way a file or pipe reader would
+    const size_t chunkSize = 64 << 10;
+    long long checksum = 0;
+    MoveParser parser;
+    auto sink = [&checksum](int move) { checksum += move; };
+    auto start = std::chrono::steady_clock::now();
+    for (size_t offset = 0; offset < text.size(); offset += chunkSize)
+        parser.feed(std::string_view(text).substr(offset, chunkSize), sink);
+    parser.finish(sink);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  parse: " << text.size() / seconds / 1e6 << " MB/s (checksum " << checksum << ")" << std::endl;
+
+    std::vector<int> moves;
+    std::string error;
+    parseMoves(text, moves, error);
+    start = std::chrono::steady_clock::now();
+    std::string formatted = formatMoves(moves);
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  format: " << formatted.size() / seconds / 1e6 << " MB/s (" << moves.size() << " moves)" << std::endl;
+}
+
+// Uniform random states against the old way of scrambling, and a check that they look uniform:
+// chi-square of what lands in one corner and one edge slot, which should be near its degrees of
+// freedom (7 and 11)
+void benchRandomStates() {
+    std::cout << "Random states" << std::endl;
+    RubiksCube cube;
+    double ns = nsPerOp(2000, [&](long long i) { cube.mixCube(uint64_t(i)); });
+    report("RubiksCube::mixCube, 20 to 49 turns", ns, cube.getCubes()[0].slot);
+
+    // A cube and a stream per thread, nothing shared; each thread then replays its scrambles on a
+    // second cube from the same seed and stream, which must end up identical
+    const int threads = std::max(2, int(std::thread::hardware_concurrency()));
+    const int scramblesPerThread = 2000;
+    std::atomic<int> mismatches{0};
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++)
+        workers.emplace_back([&mismatches, t] {
+            RubiksCube scrambled, replayed;
+            RandomStream stream(19, uint64_t(t)), replay(19, uint64_t(t));
+            for (int i = 0; i < scramblesPerThread; i++)
+                if (scrambled.mixCube(stream) != replayed.mixCube(replay))
+                    mismatches++;
+            for (size_t i = 0; i < scrambled.getCubes().size(); i++)
+                if (scrambled.getCubes()[i].slot != replayed.getCubes()[i].slot ||
+                    scrambled.getCubes()[i].orientation != replayed.getCubes()[i].orientation)
+                    mismatches++;
+        });
+    for (std::thread& worker : workers)
+        worker.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  mixCube on " << threads << " threads, a stream each: " << 2.0 * threads * scramblesPerThread / seconds
+              << " scrambles/s, " << mismatches.load() << " replay mismatches" << std::endl;
+
+    RandomStream random(1);
+    long long checksum = 0;
+    ns = nsPerOp(4000000, [&](long long) { checksum += randomState(random).edges & 0xFF; });
+    report("randomState, one stream", ns, checksum);
+    checksum = 0;
+    ns = nsPerOp(4000000, [&](long long i) { checksum += randomState(18, uint64_t(i)).edges & 0xFF; });
+    report("randomState, stream per state", ns, checksum);
+
+    WorkStealingPool pool;
+    std::vector<CubeState> states(size_t(1) << 23);
+    start = std::chrono::steady_clock::now();
+    randomStates(18, 0, states, &pool);
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  randomStates on " << pool.threadCount() << " threads: " << states.size() / seconds / 1e6 << " M states/s" << std::endl;
+
+    long long invalid = 0, different = 0;
+    long long corners[NUM_CORNERS] = {}, edges[NUM_EDGES] = {};
+    for (size_t i = 0; i < states.size(); i++) {
+        invalid += !states[i].isValid();
+        corners[states[i].cornerCubie(0)]++;
+        edges[states[i].edgeCubie(0)]++;
+        if (i % 4099 == 0)
+            different += states[i] != randomState(18, i);
+    }
+    auto chiSquare = [&states](const long long* counts, int bins) {
+        const double expected = double(states.size()) / bins;
+        double sum = 0.0;
+        for (int i = 0; i < bins; i++)
+            sum += (counts[i] - expected) * (counts[i] - expected) / expected;
+        return sum;
+    };
+    std::cout << "  " << invalid << " invalid, " << different << " different from one stream per state, chi-square "
+              << chiSquare(corners, NUM_CORNERS) << " (corner slot), " << chiSquare(edges, NUM_EDGES) << " (edge slot)" << std::endl;
+}
+
+void benchSolver() {
+    std::cout << "Two-phase solver" << std::endl;
+    const int scrambles = 200;
+    auto start = std::chrono::steady_clock::now();
+    SolverTables tables;
+    Solver solver(tables);
+    double setupSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  table generation: " << setupSeconds << " s" << std::endl;
+
+    std::string error;
+    const std::string path = "solver.tables.bench";
+    if (tables.save(path, error)) {
+        start = std::chrono::steady_clock::now();
+        SolverTables mapped(path);
+        double mapSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  table mapping: " << mapSeconds * 1000.0 << " ms" << (mapped.isMapped() ? "" : " (fell back to generating)") << std::endl;
+        std::remove(path.c_str());
+    } else {
+        std::cout << "  table mapping: skipped, " << error << std::endl;
+    }
+
+    std::vector<CubeState> states(scrambles);
+    randomStates(2024, 0, states);
+
+    long long totalMoves = 0;
+    int failures = 0;
+    std::vector<int> moves;
+    start = std::chrono::steady_clock::now();
+    for (const CubeState& state : states) {
+        if (solver.solve(state, moves))
+            totalMoves += moves.size();
+        else
+            failures++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  " << scrambles / seconds << " solves/s, " << 1000.0 * seconds / scrambles << " ms/solve, "
+              << double(totalMoves) / (scrambles - failures) << " moves on average, " << failures << " failures" << std::endl;
+}
+
+// Conjugation and reduction cost, and how far reduction shrinks the states within a few moves
+void benchSymmetry() {
+    std::cout << "Symmetry reduction" << std::endl;
+    std::mt19937 random(48);
+    std::vector<CubeState> states(1024, CubeState::solved());
+    for (CubeState& state : states)
+        for (int j = 0; j < 30; j++)
+            state.applyMove(int(random() % NUM_MOVES));
+    conjugate(states[0], 1); // build the tables outside the timing
+
+    long long checksum = 0;
+    double ns = nsPerOp(4000000, [&](long long i) {
+        checksum += conjugate(states[i & 1023], int(i % SYMMETRY_COUNT)).edges & 0xFF;
+    });
+    report("conjugate", ns, checksum);
+    checksum = 0;
+    ns = nsPerOp(100000, [&](long long i) {
+        checksum += reduceBySymmetry(states[i & 1023]).symmetry;
+    });
+    report("reduceBySymmetry", ns, checksum);
+
+    // States that differ only in centre spin are the same position
+    const uint64_t CUBIE_MASK = (uint64_t(1) << 40) - 1;
+    auto key = [](const CubeState& state) { return state.edges * 0x9E3779B97F4A7C15ull ^ (state.corners & CUBIE_MASK); };
+    std::unordered_set<uint64_t> seen = {key(CubeState::solved())}, classes = {key(CubeState::solved())};
+    std::vector<CubeState> frontier = {CubeState::solved()};
+    for (int depth = 1; depth <= 5; depth++) {
+        std::vector<CubeState> next;
+        for (const CubeState& state : frontier)
+            for (int move = 0; move < NUM_MOVES; move++) {
+                CubeState moved = state;
+                moved.applyMove(move);
+                if (seen.insert(key(moved)).second) {
+                    next.push_back(moved);
+                    classes.insert(key(reduceBySymmetry(moved).representative));
+                }
+            }
+        frontier.swap(next);
+        std::cout << "  within " << depth << " moves: " << seen.size() << " states, " << classes.size() << " classes ("
+                  << double(seen.size()) / classes.size() << "x)" << std::endl;
+    }
+}
+
+// Threads replaying a skewed mix of scrambles, each seen as a random rotation, mirror image or
+// inverse, through a cache too small for all of them; a miss "solves" by undoing the scramble
+void benchSolutionCache() {
+    std::cout << "Solution cache" << std::endl;
+    const int scrambles = 50000;
+    const long long lookupsPerThread = 200000;
+    std::mt19937 random(15);
+    std::vector<std::vector<int>> scrambleMoves(scrambles);
+    for (std::vector<int>& moves : scrambleMoves)
+        for (int j = 0; j < 20; j++)
+            moves.push_back(int(random() % NUM_MOVES));
+
+    const int maxThreads = std::max(4, int(std::thread::hardware_concurrency())); // contended even on small machines
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        SolutionCache cache(size_t(1) << 20);
+        std::atomic<long long> wrong{0};
+        auto work = [&](int thread) {
+            std::mt19937 local(thread);
+            std::vector<int> moves;
+            for (long long i = 0; i < lookupsPerThread; i++) {
+                const double u = std::uniform_real_distribution<double>(0.0, 1.0)(local);
+                const std::vector<int>& scramble = scrambleMoves[int(u * u * u * scrambles)];
+                const int symmetry = int(local() % SYMMETRY_COUNT);
+                const bool inverted = local() % 2;
+                CubeState state = CubeState::solved();
+                for (int move : scramble)
+                    state.applyMove(move);
+                state = conjugate(inverted ? state.inverse() : state, symmetry);
+                if (cache.lookup(state, moves)) {
+                    CubeState check = state;
+                    for (int move : moves)
+                        check.applyMove(move);
+                    if (!check.isSolved())
+                        wrong++;
+                    continue;
+                }
+                moves = scramble;
+                if (!inverted) {
+                    std::reverse(moves.begin(), moves.end());
+                    for (int& move : moves)
+                        move = inverseMove(move);
+                }
+                conjugateMoves(moves, symmetry);
+                cache.insert(state, moves);
+            }
+        };
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++)
+            workers.emplace_back(work, t);
+        for (std::thread& worker : workers)
+            worker.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        SolutionCache::Stats stats = cache.stats();
+        std::cout << "  " << threads << " threads: " << threads * lookupsPerThread / seconds / 1e6 << " M lookups/s, hit rate "
+                  << 100.0 * stats.hits / (stats.hits + stats.misses) << "%, " << stats.evictions << " evictions of "
+                  << stats.capacity << " entries (" << (cache.memoryBytes() >> 10) << " KiB), " << wrong.load()
+                  << " wrong solutions" << std::endl;
+    }
+}
+
+void benchPruneLookup() {
+    std::cout << "Pruning table lookup" << std::endl;
+    const size_t entries = size_t(CORNER_PERM_COUNT) * SLICE_PERM_COUNT * 32; // bigger than L2
+    const int batch = SolverTables::MAX_BATCH;
+    std::mt19937 random(7);
+    std::vector<uint8_t> bytes(entries);
+    for (uint8_t& distance : bytes)
+        distance = uint8_t(random() % 13);
+    std::vector<uint8_t> packed;
+    PruneTable::pack(bytes, packed);
+    PruneTable table(packed.data());
+    std::cout << "  " << bytes.size() / 1024 << " KiB as bytes, " << packed.size() / 1024 << " KiB packed" << std::endl;
+
+    std::vector<uint32_t> indices(1 << 16);
+    for (uint32_t& index : indices)
+        index = uint32_t(random() % entries);
+
+    // The batch lookup must agree with the scalar one before its time means anything; every
+    // count up to a full batch, so the gather's tail is covered too
+    uint8_t distances[SolverTables::MAX_BATCH];
+    long long mismatches = 0;
+    for (size_t first = 0; first + batch <= indices.size(); first += batch) {
+        const int count = 1 + int(first / batch) % batch;
+        table.lookup(&indices[first], count, distances);
+        for (int j = 0; j < count; j++)
+            mismatches += distances[j] != table[indices[first + j]] || distances[j] != bytes[indices[first + j]];
+    }
+    std::cout << "  " << mismatches << " batch lookup mismatches" << std::endl;
+
+    const long long blocks = 2000000;
+    long long checksum = 0;
+    double ns = nsPerOp(blocks, [&](long long i) {
+        const uint32_t* block = &indices[(i * batch) & (indices.size() - 32)];
+        for (int j = 0; j < batch; j++)
+            checksum += bytes[block[j]];
+    });
+    report("byte table, " + std::to_string(batch) + " lookups", ns, checksum);
+    checksum = 0;
+    ns = nsPerOp(blocks, [&](long long i) {
+        const uint32_t* block = &indices[(i * batch) & (indices.size() - 32)];
+        for (int j = 0; j < batch; j++)
+            checksum += table[block[j]];
+    });
+    report("packed table, " + std::to_string(batch) + " scalar lookups", ns, checksum);
+    checksum = 0;
+    ns = nsPerOp(blocks, [&](long long i) {
+        table.lookup(&indices[(i * batch) & (indices.size() - 32)], batch, distances);
+        for (int j = 0; j < batch; j++)
+            checksum += distances[j];
+    });
+#ifdef __AVX2__
+    report("packed table, batch lookup (AVX2)", ns, checksum);
+#else
+    report("packed table, batch lookup (scalar build)", ns, checksum);
+#endif
+}
+
+// Depth-first to depth for a move sequence that takes state into the phase 1 subgroup, bounded
+// by the phase 1 pruning tables; coordinates come from the state after every CubeState move
+bool reachesSubgroup(const SolverTables& tables, const CubeState& state, int depth, int lastFace, long long& nodes) {
+    nodes++;
+    const int bound = tables.phase1Distance(twistCoord(state), flipCoord(state), sliceCoord(state));
+    if (bound == 0)
+        return true;
+    if (bound > depth)
+        return false;
+    for (int move = 0; move < NUM_MOVES; move++) {
+        if (isRedundantAfter(lastFace, moveFace(move)))
+            continue;
+        CubeState moved = state;
+        moved.applyMove(move);
+        if (reachesSubgroup(tables, moved, depth - 1, moveFace(move), nodes))
+            return true;
+    }
+    return false;
+}
+
+// How far positions are from solved. The 2x2x2 is the corners of the 3x3x3 with the DBL corner
+// held still by turning only R, U and F: every one of its 3674160 positions is reached
+// breadth-first, deduplicated in an open-addressing hash set. The 3x3x3 is sampled: random cosets
+// of the phase 1 subgroup <U, D, R2, L2, F2, B2>, each with the exact distance to the subgroup.
+// Seeds are fixed, so the distributions only change when the move engine is wrong.
+void benchDistances() {
+    std::cout << "Distance distribution" << std::endl;
+    const long long known2x2[] = {1, 9, 54, 321, 1847, 9992, 50136, 227536, 870072, 1887748, 623800, 2644};
+    const int moves2x2[] = {makeMove(0, 1), makeMove(0, 2), makeMove(0, 3), makeMove(2, 1), makeMove(2, 2),
+                            makeMove(2, 3), makeMove(5, 1), makeMove(5, 2), makeMove(5, 3)};
+    const uint64_t cornerMask = (uint64_t(1) << 40) - 1; // centre spin left out
+    std::vector<uint64_t> seen(size_t(1) << 23, 0);      // no corner word is 0
+    auto insert = [&seen](uint64_t corners) {
+        uint64_t hash = corners * 0x9E3779B97F4A7C15ull;
+        for (size_t i = hash >> 41;; i = (i + 1) & (seen.size() - 1)) {
+            if (seen[i] == corners)
+                return false;
+            if (seen[i] == 0) {
+                seen[i] = corners;
+                return true;
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    CubeState solved = CubeState::solved();
+    insert(solved.corners & cornerMask);
+    std::vector<CubeState> frontier = {solved};
+    std::vector<long long> counts = {1};
+    long long turns = 0;
+    while (!frontier.empty()) {
+        std::vector<CubeState> next;
+        for (const CubeState& state : frontier)
+            for (int move : moves2x2) {
+                CubeState moved = state;
+                moved.applyMove(move);
+                if (insert(moved.corners & cornerMask))
+                    next.push_back(moved);
+            }
+        turns += frontier.size() * 9;
+        if (!next.empty())
+            counts.push_back(next.size());
+        frontier.swap(next);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    long long total = 0;
+    std::cout << "  2x2x2 by depth:";
+    for (long long count : counts) {
+        std::cout << " " << count;
+        total += count;
+    }
+    const bool matches = std::equal(counts.begin(), counts.end(), std::begin(known2x2), std::end(known2x2));
+    std::cout << std::endl << "  2x2x2: " << total << " positions in " << seconds << " s, " << turns / seconds / 1e6
+              << " M turns/s, " << (seen.size() * sizeof(uint64_t) >> 20) << " MiB hash set, "
+              << (matches ? "matches" : "DOES NOT MATCH") << " the known distribution" << std::endl;
+
+    const int samples = 2000;
+    SolverTables tables;
+    std::mt19937 random(17);
+    std::vector<int> depths;
+    long long nodes = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < samples; i++) {
+        CubeState state = CubeState::solved();
+        setSliceCoord(state, int(random() % SLICE_COUNT));
+        setFlipCoord(state, int(random() % FLIP_COUNT));
+        setTwistCoord(state, int(random() % TWIST_COUNT));
+        int depth = 0;
+        while (!reachesSubgroup(tables, state, depth, -1, nodes))
+            depth++;
+        if (depth >= int(depths.size()))
+            depths.resize(depth + 1);
+        depths[depth]++;
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  3x3x3 phase 1 cosets by depth:";
+    for (int count : depths)
+        std::cout << " " << count;
+    std::cout << std::endl << "  3x3x3: " << samples << " sampled cosets in " << seconds << " s, " << nodes / seconds / 1e6
+              << " M nodes/s" << std::endl;
+}
+
+void benchOptimalScaling() {
+    std::cout << "Optimal solver scaling" << std::endl;
+    SolverTables tables;
+
+    // Fixed corpus of 12-move scrambles (no cancelling moves)
+    std::mt19937 random(12);
+    std::vector<CubeState> corpus;
+    for (int i = 0; i < 8; i++) {
+        CubeState state = CubeState::solved();
+        int lastFace = -1;
+        for (int j = 0; j < 12; j++) {
+            int move;
+            do {
+                move = int(random() % NUM_MOVES);
+            } while (isRedundantAfter(lastFace, moveFace(move)));
+            lastFace = moveFace(move);
+            state.applyMove(move);
+        }
+        corpus.push_back(state);
+    }
+
+    int hardware = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    std::vector<int> threadCounts = {1, 2, 4, 8, hardware};
+    std::sort(threadCounts.begin(), threadCounts.end());
+    threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+
+    double baseline = 0.0;
+    for (int threads : threadCounts) {
+        OptimalSolver solver(tables, threads);
+        long long totalMoves = 0, totalNodes = 0;
+        std::vector<int> moves;
+        auto start = std::chrono::steady_clock::now();
+        for (const CubeState& state : corpus) {
+            solver.solve(state, moves);
+            totalMoves += moves.size();
+            totalNodes += solver.lastNodeCount();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (threads == 1)
+            baseline = seconds;
+        std::cout << "  " << threads << " threads: " << seconds << " s, speedup " << baseline / seconds << ", "
+                  << totalNodes / seconds << " nodes/s, " << double(totalMoves) / corpus.size() << " moves on average" << std::endl;
+    }
+
+    // The same corpus bounded by the corner pattern database, when TableTool pdb corners has built it
+    OptimalSolver solver(tables, hardware);
+    std::string error;
+    if (!solver.useCornerDatabase(PatternDatabase::CORNER_PATH, error)) {
+        std::cout << "  corner pattern database: skipped, " << error << std::endl;
+        return;
+    }
+    long long totalMoves = 0, totalNodes = 0;
+    std::vector<int> moves;
+    auto start = std::chrono::steady_clock::now();
+    for (const CubeState& state : corpus) {
+        solver.solve(state, moves);
+        totalMoves += moves.size();
+        totalNodes += solver.lastNodeCount();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  " << hardware << " threads with the corner pattern database: " << seconds << " s, "
+              << totalNodes << " nodes, " << double(totalMoves) / corpus.size() << " moves on average" << std::endl;
+}
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+const Benchmark BENCHMARKS[] = {
+    {"turns", benchFaceTurns},
+    {"layers", benchLayerTurns},
+    {"matrices", benchCubieMatrices},
+    {"picking", benchRayPicking},
+    {"animation", benchAnimation},
+    {"notation", benchNotation},
+    {"symmetry", benchSymmetry},
+    {"cache", benchSolutionCache},
+    {"random", benchRandomStates},
+    {"solver", benchSolver},
+    {"prune", benchPruneLookup},
+    {"distances", benchDistances},
+    {"optimal", benchOptimalScaling},
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    for (const Benchmark& benchmark : BENCHMARKS) {
+        bool selected = argc == 1;
+        for (int i = 1; i < argc; i++)
+            selected = selected || std::strcmp(argv[i], benchmark.name) == 0;
+        if (selected)
+            benchmark.run();
+    }
+    return 0;
+}
@@ -1,6 +1,6 @@
 #include <../src/Camera.h>
-#include <thread> // Required for std::this_thread
-#include <chrono> // Required for std::chrono::milliseconds
+#include <Solver.h>
+#include <random>
 
 void Camera::SetOrthographic(float near, float far){
     m_Near = near;
@@ -43,27 +43,27 @@ void KeyCallback(GLFWwindow* window, int key, int scanCode, int action, int mods
         {
             case GLFW_KEY_R:
                 std::cout << "RIGHT Pressed" << std::endl;
-                camera->remoteCubeFaceRotation(window, 0, glm::vec3(1.0f,0.0f,0.0f),degreeMovement);
+                camera->remoteCubeFaceRotation(0, glm::vec3(1.0f,0.0f,0.0f),degreeMovement);
                 break;
             case GLFW_KEY_L:
                 std::cout << "LEFT Pressed" << std::endl;
-                camera->remoteCubeFaceRotation(window, 1, glm::vec3(1.0f,0.0f,0.0f),degreeMovement);
+                camera->remoteCubeFaceRotation(1, glm::vec3(1.0f,0.0f,0.0f),degreeMovement);
                 break;
             case GLFW_KEY_U:
                 std::cout << "UP Pressed" << std::endl;
-                camera->remoteCubeFaceRotation(window, 2, glm::vec3(0.0f,1.0f,0.0f),degreeMovement);
+                camera->remoteCubeFaceRotation(2, glm::vec3(0.0f,1.0f,0.0f),degreeMovement);
                 break;
             case GLFW_KEY_D:
                 std::cout << "DOWN Pressed" << std::endl;
-                camera->remoteCubeFaceRotation(window, 3, glm::vec3(0.0f,1.0f,0.0f),degreeMovement);
+                camera->remoteCubeFaceRotation(3, glm::vec3(0.0f,1.0f,0.0f),degreeMovement);
                 break;
             case GLFW_KEY_B:
                 std::cout << "BACK Pressed" << std::endl;
-                camera->remoteCubeFaceRotation(window, 4, glm::vec3(0.0f,0.0f,1.0f),degreeMovement);
+                camera->remoteCubeFaceRotation(4, glm::vec3(0.0f,0.0f,1.0f),degreeMovement);
                 break;
             case GLFW_KEY_F:
                 std::cout << "FRONT Pressed" << std::endl;
-                camera->remoteCubeFaceRotation(window, 5, glm::vec3(0.0f,0.0f,1.0f),degreeMovement);
+                camera->remoteCubeFaceRotation(5, glm::vec3(0.0f,0.0f,1.0f),degreeMovement);
                 break;
             case GLFW_KEY_SPACE:
                 std::cout << "SPACE - flipping rotation direction. Pressed" << std::endl;
@@ -75,17 +75,55 @@ void KeyCallback(GLFWwindow* window, int key, int scanCode, int action, int mods
                     camera->m_DegreeAmout *=2;
                 break;
             case GLFW_KEY_Z:
+                if (mods & GLFW_MOD_CONTROL) {
+                    std::cout << "CTRL+Z - undo Pressed" << std::endl;
+                    camera->m_Animations.finish(*camera->m_RubiksCube);
+                    camera->m_RubiksCube->undoMove();
+                    break;
+                }
                 std::cout << "Z - divide angle by 2 Pressed" << std::endl;
                 if (camera->m_DegreeAmout != 45)
                     camera->m_DegreeAmout /=2;
                 break;
+            case GLFW_KEY_Y:
+                if (mods & GLFW_MOD_CONTROL) {
+                    std::cout << "CTRL+Y - redo Pressed" << std::endl;
+                    camera->m_Animations.finish(*camera->m_RubiksCube);
+                    camera->m_RubiksCube->redoMove();
+                }
+                break;
             case GLFW_KEY_P:
                 std::cout << "P - color picking" << std::endl;
                 camera->m_PickingMode = !camera->m_PickingMode;
                 break;
-            case GLFW_KEY_M:
-                std::cout << "M - mix" << std::endl;
-                camera->m_RubiksCube->mixCube();
+            case GLFW_KEY_G:
+                camera->m_RayPicking = !camera->m_RayPicking;
+                std::cout << "G - picking by " << (camera->m_RayPicking ? "ray casting" : "GPU id buffer") << std::endl;
+                break;
+            case GLFW_KEY_M: {
+                // Printed so a scramble that goes wrong can be replayed with the same seed
+                std::random_device device;
+                const uint64_t seed = uint64_t(device()) << 32 | device();
+                std::cout << "M - mix, seed " << seed << std::endl;
+                camera->m_Animations.finish(*camera->m_RubiksCube);
+                camera->m_RubiksCube->mixCube(seed);
+                break;
+            }
+            case GLFW_KEY_S:
+                std::cout << "S - solve" << std::endl;
+                camera->SolveCube();
+                break;
+            case GLFW_KEY_ENTER:
+                std::cout << "ENTER - finish the queued turns" << std::endl;
+                camera->m_Animations.finish(*camera->m_RubiksCube);
+                break;
+            case GLFW_KEY_EQUAL:
+                std::cout << "+ - turn twice as fast" << std::endl;
+                camera->m_Animations.setTurnSeconds(camera->m_Animations.getTurnSeconds() / 2);
+                break;
+            case GLFW_KEY_MINUS:
+                std::cout << "- - turn half as fast" << std::endl;
+                camera->m_Animations.setTurnSeconds(camera->m_Animations.getTurnSeconds() * 2);
                 break;
             case GLFW_KEY_UP:
                 std::cout << "UP - rotate the cube upwards" << std::endl;
@@ -105,6 +143,7 @@ void KeyCallback(GLFWwindow* window, int key, int scanCode, int action, int mods
                 break;
             case GLFW_KEY_ESCAPE:
                 std::cout << "ESCAPE - reset RubiksCube" << std::endl;
+                camera->m_Animations.clear();
                 camera->m_RubiksCube->resetCube();
                 break;
             default:
@@ -120,56 +159,25 @@ void MouseButtonCallback(GLFWwindow* window, double currMouseX, double currMouse
     int width, height;
     glfwGetWindowSize(window, &width, &height);
     if (camera->m_PickingMode && (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS || glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS)) {
-            // Clear the screen (Color and Depth Buffers)
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-            // Render cubes with unique colors for picking
-            const auto& cubes = camera->m_RubiksCube->getCubes();
-            for (size_t i = 0; i < cubes.size(); ++i) {
-                const Cube& cube = cubes[i];
-
-                // Encode cube ID into color
-                int cubeID = cube.id + 1; // Avoid (0, 0, 0) black for no cube
-                int r = glm::clamp((cubeID & 0xFF), 0, 255);
-                int g = glm::clamp((cubeID >> 8) & 0xFF, 0, 255);
-                int b = glm::clamp((cubeID >> 16) & 0xFF, 0, 255);
-                glm::vec4 pickingColor = glm::vec4(r / 255.0f, g / 255.0f, b / 255.0f, 1.0f);
-
-                // Render the cube with the picking color
-                camera->m_Shader->Bind();
-                camera->m_Shader->SetUniform4f("u_Color", pickingColor);
-                camera->m_Shader->SetUniform1i("u_PickingMode", true);
-
-                // Update MVP matrix for the cube
-                glm::mat4 model = glm::translate(glm::mat4(1.0f), cube.position+glm::vec3(0.0f, 0.0f, -10.0f)) * cube.rotationMatrix;
-                glm::mat4 mvp = camera->GetProjectionMatrix() * camera->GetViewMatrix() * model;
-                camera->m_Shader->SetUniformMat4f("u_MVP", mvp);
-
-                // Bind VAO and draw
-                camera->m_VA->Bind();
-                camera->m_IB->Bind();
-                GLCall(glDrawElements(GL_TRIANGLES, camera->m_IB->GetCount(), GL_UNSIGNED_INT, nullptr));
-            }
-
-            // Read the color at the mouse position
-            unsigned char color[4];
-            int x = static_cast<int>(currMouseX);
-            int y = static_cast<int>(currMouseY);
-            glReadPixels(x, height - y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, color);
-
-
-            // Decode color to get cube ID
-            int cubeID = color[0] | (color[1] << 8) | (color[2] << 16);
-            camera->m_pickedCubeID = cubeID - 1; // Convert back to index (subtract 1)
-
-            if ( camera->m_pickedCubeID >= 0 &&  camera->m_pickedCubeID < static_cast<int>(cubes.size())) {
-                std::cout << "Picked Cube ID: " <<  camera->m_pickedCubeID << std::endl;
+        if (camera->m_RayPicking) {
+            // Cast the ray under the mouse against the cubies, no GPU involved
+            Ray ray = pickingRay(camera->GetViewMatrix(), camera->GetProjectionMatrix(), width, height, currMouseX, currMouseY);
+            RayHit hit;
+            if (pickCubie(*camera->m_RubiksCube, glm::translate(glm::mat4(1.0f), CUBE_CENTER), ray, hit)) {
+                camera->m_pickedCubeID = hit.id;
+                std::cout << "Picked Cube ID: " << hit.id << " on face " << "RLUDBF"[hit.face] << std::endl;
             } else {
                 std::cout << "No cube picked." << std::endl;
-                 camera->m_pickedCubeID = -1; // Reset if no cube was picked
+                camera->m_pickedCubeID = -1;
             }
-            glFlush(); // Ensure rendering commands are executed
-            camera->m_Shader->SetUniform1i("u_PickingMode", false);
+        } else {
+            // Draw the cube ids offscreen and start reading the one under the mouse; render picks
+            // it up once the GPU is done, so until then there is no picked cube to drag
+            int x = static_cast<int>(currMouseX);
+            int y = static_cast<int>(currMouseY);
+            camera->m_pickedCubeID = -1;
+            camera->m_Picking->request(*camera->m_RubiksCube, camera->GetProjectionMatrix() * camera->GetViewMatrix(), width, height, x, height - 1 - y);
+        }
     }
     if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
         std::cout << "MOUSE LEFT Click" << std::endl;
@@ -203,8 +211,6 @@ void CursorPosCallback(GLFWwindow* window, double currMouseX, double currMouseY)
             std::cout << "MOUSE LEFT Click - Rotate Cube ID: " << camera->m_pickedCubeID << std::endl;
 
             // Rotate the chosen cube based on mouse movement
-            Cube& pickedCube = camera->m_RubiksCube->getCubes()[camera->m_pickedCubeID];
-
             // Rotate around Y axis for horizontal mouse movement
             glm::mat4 rotationY = glm::rotate(glm::mat4(1.0f), glm::radians(-deltaX), glm::vec3(0.0f, 1.0f, 0.0f));
             // Rotate around X axis for vertical mouse movement
@@ -212,7 +218,7 @@ void CursorPosCallback(GLFWwindow* window, double currMouseX, double currMouseY)
             glm::mat4 rotationX = glm::rotate(glm::mat4(1.0f), glm::radians(-deltaY), right);
 
             // Combine the rotations and apply to the cube
-            pickedCube.rotationMatrix = rotationY * rotationX * pickedCube.rotationMatrix;
+            camera->m_RubiksCube->dragCubie(camera->m_pickedCubeID, rotationY * rotationX, glm::vec3(0.0f));
         }
         else { // No color picking
             // Store initial vectors before rotation
@@ -260,14 +266,12 @@ void CursorPosCallback(GLFWwindow* window, double currMouseX, double currMouseY)
             std::cout << "MOUSE RIGHT Click - Translating Cube ID: " <<  camera->m_pickedCubeID << std::endl;
 
             // Translate the chosen cube based on mouse movement
-            Cube& pickedCube = camera->m_RubiksCube->getCubes()[camera->m_pickedCubeID];
-
             float moveSpeed = 0.05f;
             glm::vec3 right = glm::normalize(glm::cross(camera->getOrientation(), camera->getUp()));
             glm::vec3 translation = right * (-deltaX) * moveSpeed - camera->getUp() * (-deltaY) * moveSpeed;
 
             // Update cube's position
-            pickedCube.position += translation;
+            camera->m_RubiksCube->dragCubie(camera->m_pickedCubeID, glm::mat4(1.0f), translation);
         }
         else {
             std::cout << "MOUSE RIGHT Motion" << std::endl;
@@ -394,59 +398,51 @@ void Camera::ArrowKeyCallback(int key) {
 
 void Camera::render(GLFWwindow* window)
 {
+    /* Move the queued turns on by the time since the last frame */
+    double now = glfwGetTime();
+    if (m_LastFrameTime >= 0.0)
+        m_Animations.update(*m_RubiksCube, now - m_LastFrameTime);
+    m_LastFrameTime = now;
+    /* Collect a pick requested by a click, if the GPU has finished it */
+    int cubeID;
+    if (m_Picking && m_Picking->poll(cubeID)) {
+        if (cubeID >= 0 && cubeID < static_cast<int>(m_RubiksCube->getCubes().size())) {
+            m_pickedCubeID = cubeID;
+            std::cout << "Picked Cube ID: " << m_pickedCubeID << std::endl;
+        } else {
+            std::cout << "No cube picked." << std::endl;
+            m_pickedCubeID = -1;
+        }
+    }
     /* Set white background color */
     GLCall(glClearColor(1.0f, 1.0f, 1.0f, 1.0f));
     /* Render here */
     GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
-    for (const auto &cube : m_RubiksCube->getCubes())
-    {
-        glm::mat4 trans = glm::translate(glm::mat4(1.0f), cube.position + glm::vec3(0.0f, 0.0f, -10.0f));
-        glm::mat4 rot = cube.rotationMatrix;
-        glm::mat4 scl = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f)); // No scaling
-
-        // Compute Model-View-Projection (MVP) matrix
-        glm::mat4 model = trans * rot * scl;
-        glm::mat4 mvp = GetProjectionMatrix() * GetViewMatrix() * model;
-
-        // Bind shader and set uniforms
-        m_Shader->Bind();
-        m_Shader->SetUniformMat4f("u_MVP", mvp);
-        m_Shader->SetUniform1i("u_Texture", 0);
-
-        // Bind VAO and Index Buffer, then draw
-        m_VA->Bind();
-        m_IB->Bind();
-        GLCall(glDrawElements(GL_TRIANGLES, m_IB->GetCount(), GL_UNSIGNED_INT, nullptr));
-    }
-    /* Update shaders paramters and draw to the screen */
-    glm::vec4 color = glm::vec4(1.0, 1.0f, 1.0f, 1.0f);
-    m_Shader->SetUniform4f("u_Color", color);
+    m_Renderer->draw(*m_RubiksCube, GetProjectionMatrix() * GetViewMatrix());
     /* Swap front and back buffers */
     glfwSwapBuffers(window);
     /* Poll for and process events */
     glfwPollEvents();
 }
 
-void Camera::remoteCubeFaceRotation(GLFWwindow* window, int face, glm::vec3 rotationAxis, float degree) {
-    const int steps = 30; // Number of animation steps
-    const float totalAnimationTime = 1.0f; // Total animation time in seconds
-    const float stepDuration = totalAnimationTime / steps; // Duration of each step in seconds
-    const float angleStep = degree / steps; // Angle to rotate per step
-
-    float currentAngle = 0.0f;
-    float isLocked = glm::dot(rotationAxis,m_RubiksCube->locks);
-    std::cout << "if isLocked: " << isLocked << std::endl;
-    if(isLocked == 0){
-        for (int step = 0; step < steps; step++) {
-            if(step != steps - 1) //not the final update
-                m_RubiksCube->remoteCubeFaceRotation(face, rotationAxis, angleStep, 0.0f);
-            else m_RubiksCube->remoteCubeFaceRotation(face, rotationAxis, angleStep, degree); // mark cube to add transition
-            render(window);
-            currentAngle += angleStep;
-            std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(stepDuration * 300)));
-        }
-        float correctionAngle = degree - currentAngle;
-        if (std::abs(correctionAngle) > 0.001f)
-            m_RubiksCube->remoteCubeFaceRotation(face, rotationAxis, correctionAngle, 0.0f);
+void Camera::remoteCubeFaceRotation(int face, glm::vec3 rotationAxis, float degree) {
+    m_Animations.push(face / 2, m_RubiksCube->faceLayer(face), rotationAxis[face / 2] < 0.0f ? -degree : degree);
+}
+
+void Camera::SolveCube() {
+    if (m_RubiksCube->getSize() != 3) {
+        std::cout << "The solver only handles a 3x3x3 cube" << std::endl;
+        return;
+    }
+    static SolverTables tables(SolverTables::DEFAULT_PATH); // mapped (or generated) on the first solve
+    Solver solver(tables);
+    m_Animations.finish(*m_RubiksCube); // solve from where the queued turns leave the cube
+    std::vector<FaceRotation> solution;
+    if (!solver.solve(*m_RubiksCube, solution)) {
+        std::cout << "Cannot solve the cube while a face is mid-turn" << std::endl;
+        return;
     }
+    std::cout << "Solution: " << solution.size() << " moves" << std::endl;
+    for (const FaceRotation& step : solution)
+        remoteCubeFaceRotation(step.face, step.axis, step.angle);
 }
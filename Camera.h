@@ -14,6 +14,10 @@
 #include <RubiksCube.h>
 #include <IndexBuffer.h>
 #include <VertexArray.h>
+#include <CubeRenderer.h>
+#include <PickingBuffer.h>
+#include <RayPicker.h>
+#include <AnimationQueue.h>
 
 class Camera
 {
@@ -53,11 +57,16 @@ class Camera
         Shader* m_Shader; 
         VertexArray* m_VA;       // Pointer to Vertex Array
         IndexBuffer* m_IB;
+        CubeRenderer* m_Renderer; // draws all the cubies in one call
+        PickingBuffer* m_Picking = nullptr; // ids under the mouse, read back a frame after the click
         bool m_PickingMode = false;
+        bool m_RayPicking = true; // pick by ray casting on the CPU, else by m_Picking on the GPU
         int m_pickedCubeID = -1;
         // Movment
         bool m_ClockwiseMovment = true;
         float m_DegreeAmout = 90.0f;
+        AnimationQueue m_Animations; // turns waiting to be shown, advanced by render
+        double m_LastFrameTime = -1.0;
 
     public:
         Camera(int width, int height)
@@ -68,7 +77,8 @@ class Camera
         void SetPerspective(float near, float far, float FOV);
 
         void SetRubiksCube(RubiksCube* cube) { m_RubiksCube = cube; }
-        void SetRenderingResources(VertexArray* va, IndexBuffer* ib, Shader* shader) { m_VA = va; m_IB = ib; m_Shader = shader;}
+        void SetRenderingResources(VertexArray* va, IndexBuffer* ib, Shader* shader, CubeRenderer* renderer) { m_VA = va; m_IB = ib; m_Shader = shader; m_Renderer = renderer;}
+        void SetPickingBuffer(PickingBuffer* picking) { m_Picking = picking; }
 
 
         // Handle camera inputs
@@ -86,7 +96,8 @@ class Camera
         void RotateCubeByAngel(glm::vec3 rotationAxis, int angle);
         void ArrowKeyCallback(int key);
         void render(GLFWwindow* window);
-        void remoteCubeFaceRotation(GLFWwindow* window, int face, glm::vec3 rotationAxis, float degree);
+        void remoteCubeFaceRotation(int face, glm::vec3 rotationAxis, float degree); // queue an animated turn
+        void SolveCube();
 
 
 };
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "CubeCoordinates.h"
+
+namespace {
+
+int binomial(int n, int k) {
+    if (k < 0 || k > n) return 0;
+    int result = 1;
+    for (int i = 1; i <= k; i++)
+        result = result * (n - k + i) / i;
+    return result;
+}
+
+// Lehmer rank of a permutation of 0..n-1
+int rankPermutation(const int* perm, int n) {
+    int rank = 0;
+    for (int i = 0; i < n; i++) {
+        int smaller = 0;
+        for (int j = i + 1; j < n; j++)
+            smaller += perm[j] < perm[i];
+        rank = rank * (n - i) + smaller;
+    }
+    return rank;
+}
+
+void unrankPermutation(int rank, int* perm, int n) {
+    int digits[12];
+    for (int i = n - 1; i >= 0; i--) {
+        digits[i] = rank % (n - i);
+        rank /= n - i;
+    }
+    bool used[12] = {};
+    for (int i = 0; i < n; i++) {
+        int value = 0;
+        for (int skip = digits[i]; used[value] || skip > 0; value++)
+            if (!used[value]) skip--;
+        perm[i] = value;
+        used[value] = true;
+    }
+}
+
+} // namespace
+
+int twistCoord(const CubeState& state) {
+    int twist = 0;
+    for (int slot = 0; slot < NUM_CORNERS - 1; slot++)
+        twist = twist * 3 + state.cornerTwist(slot);
+    return twist;
+}
+
+int flipCoord(const CubeState& state) {
+    int flip = 0;
+    for (int slot = 0; slot < NUM_EDGES - 1; slot++)
+        flip = flip * 2 + state.edgeFlip(slot);
+    return flip;
+}
+
+int sliceCoord(const CubeState& state) {
+    // Combinatorial number system over the slots holding middle-layer edges (cubies 8..11)
+    int slice = 0, k = 0;
+    for (int slot = 0; slot < NUM_EDGES; slot++)
+        if (state.edgeCubie(slot) >= 8)
+            slice += binomial(slot, ++k);
+    return slice;
+}
+
+int cornerPermCoord(const CubeState& state) {
+    int perm[NUM_CORNERS];
+    for (int slot = 0; slot < NUM_CORNERS; slot++)
+        perm[slot] = state.cornerCubie(slot);
+    return rankPermutation(perm, NUM_CORNERS);
+}
+
+int udEdgePermCoord(const CubeState& state) {
+    int perm[8];
+    for (int slot = 0; slot < 8; slot++)
+        perm[slot] = state.edgeCubie(slot);
+    return rankPermutation(perm, 8);
+}
+
+int slicePermCoord(const CubeState& state) {
+    int perm[4];
+    for (int slot = 0; slot < 4; slot++)
+        perm[slot] = state.edgeCubie(8 + slot) - 8;
+    return rankPermutation(perm, 4);
+}
+
+void setTwistCoord(CubeState& state, int twist) {
+    int sum = 0;
+    for (int slot = NUM_CORNERS - 2; slot >= 0; slot--) {
+        state.setCorner(slot, state.cornerCubie(slot), twist % 3);
+        sum += twist % 3;
+        twist /= 3;
+    }
+    state.setCorner(NUM_CORNERS - 1, state.cornerCubie(NUM_CORNERS - 1), (3 - sum % 3) % 3);
+}
+
+void setFlipCoord(CubeState& state, int flip) {
+    int sum = 0;
+    for (int slot = NUM_EDGES - 2; slot >= 0; slot--) {
+        state.setEdge(slot, state.edgeCubie(slot), flip & 1);
+        sum += flip & 1;
+        flip >>= 1;
+    }
+    state.setEdge(NUM_EDGES - 1, state.edgeCubie(NUM_EDGES - 1), sum & 1);
+}
+
+void setSliceCoord(CubeState& state, int slice) {
+    bool middle[NUM_EDGES] = {};
+    for (int k = 4; k >= 1; k--) {
+        int slot = k - 1;
+        while (binomial(slot + 1, k) <= slice)
+            slot++;
+        middle[slot] = true;
+        slice -= binomial(slot, k);
+    }
+    int nextMiddle = 8, nextOther = 0;
+    for (int slot = 0; slot < NUM_EDGES; slot++)
+        state.setEdge(slot, middle[slot] ? nextMiddle++ : nextOther++, 0);
+}
+
+void setCornerPermCoord(CubeState& state, int perm) {
+    int cubies[NUM_CORNERS];
+    unrankPermutation(perm, cubies, NUM_CORNERS);
+    for (int slot = 0; slot < NUM_CORNERS; slot++)
+        state.setCorner(slot, cubies[slot], state.cornerTwist(slot));
+}
+
+void setUdEdgePermCoord(CubeState& state, int perm) {
+    int cubies[8];
+    unrankPermutation(perm, cubies, 8);
+    for (int slot = 0; slot < 8; slot++)
+        state.setEdge(slot, cubies[slot], state.edgeFlip(slot));
+}
+
+void setSlicePermCoord(CubeState& state, int perm) {
+    int cubies[4];
+    unrankPermutation(perm, cubies, 4);
+    for (int slot = 0; slot < 4; slot++)
+        state.setEdge(8 + slot, 8 + cubies[slot], state.edgeFlip(8 + slot));
+}
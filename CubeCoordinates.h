@@ -0,0 +1,41 @@
+#ifndef CUBECOORDINATES_H
+#define CUBECOORDINATES_H
+
+#include "CubeState.h"
+
+// Integer coordinates of a CubeState used by the table-driven searches.
+// Phase 1 coordinates describe the cube modulo the subgroup <U, D, R2, L2, F2, B2>;
+// phase 2 coordinates are only meaningful for cubes inside that subgroup.
+constexpr int TWIST_COUNT = 2187;          // 3^7 corner twists
+constexpr int FLIP_COUNT = 2048;           // 2^11 edge flips
+constexpr int SLICE_COUNT = 495;           // C(12, 4) positions of the middle-layer edges
+constexpr int CORNER_PERM_COUNT = 40320;   // 8! corner permutations
+constexpr int UD_EDGE_PERM_COUNT = 40320;  // 8! permutations of the up/down layer edges (phase 2)
+constexpr int SLICE_PERM_COUNT = 24;       // 4! permutations of the middle-layer edges (phase 2)
+
+constexpr int SOLVED_SLICE = 494; // middle-layer edges in slots FR, FL, BL, BR
+
+// Moves that keep a cube inside the phase 2 subgroup: U, D in any amount and half turns elsewhere
+constexpr int PHASE2_MOVE_COUNT = 10;
+constexpr int PHASE2_MOVES[PHASE2_MOVE_COUNT] = {
+    makeMove(2, 1), makeMove(2, 2), makeMove(2, 3), makeMove(3, 1), makeMove(3, 2), makeMove(3, 3),
+    makeMove(0, 2), makeMove(1, 2), makeMove(4, 2), makeMove(5, 2)
+};
+
+int twistCoord(const CubeState& state);
+int flipCoord(const CubeState& state);
+int sliceCoord(const CubeState& state);
+int cornerPermCoord(const CubeState& state);
+int udEdgePermCoord(const CubeState& state);
+int slicePermCoord(const CubeState& state);
+
+// Overwrite one coordinate of state. The twist, flip and permutation setters keep everything
+// else; setSliceCoord rebuilds all edges (unflipped) around the new middle-layer positions.
+void setTwistCoord(CubeState& state, int twist);
+void setFlipCoord(CubeState& state, int flip);
+void setSliceCoord(CubeState& state, int slice);
+void setCornerPermCoord(CubeState& state, int perm);
+void setUdEdgePermCoord(CubeState& state, int perm);
+void setSlicePermCoord(CubeState& state, int perm);
+
+#endif // CUBECOORDINATES_H
@@ -0,0 +1,56 @@
+#ifndef CUBE_GEOMETRY_H
+#define CUBE_GEOMETRY_H
+
+// The cubie mesh every cubie is drawn with, shared by the window and the offscreen renderer.
+
+/* Shape cubeVertices coordinates with positions, colors, and corrected texCoords */
+const float cubeVertices[] = {
+    // positions                     // colors            // texCoords
+    // Front face (Red)
+    -0.5f, -0.5f,  0.5f,    1.0f, 0.0f, 0.0f,    0.0f, 0.0f,  // Bottom-left
+     0.5f, -0.5f,  0.5f,    1.0f, 0.0f, 0.0f,    1.0f, 0.0f,  // Bottom-right
+     0.5f,  0.5f,  0.5f,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f,  // Top-right
+    -0.5f,  0.5f,  0.5f,    1.0f, 0.0f, 0.0f,    0.0f, 1.0f,  // Top-left
+
+    // Back face (Green)
+    -0.5f, -0.5f, -0.5f,    0.0f, 1.0f, 0.0f,    0.0f, 0.0f,  // Bottom-left
+     0.5f, -0.5f, -0.5f,    0.0f, 1.0f, 0.0f,    1.0f, 0.0f,  // Bottom-right
+     0.5f,  0.5f, -0.5f,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f,  // Top-right
+    -0.5f,  0.5f, -0.5f,    0.0f, 1.0f, 0.0f,    0.0f, 1.0f,  // Top-left
+
+    // Left face (Blue)
+    -0.5f, -0.5f, -0.5f,    0.0f, 0.0f, 1.0f,    0.0f, 0.0f,  // Bottom-left
+    -0.5f, -0.5f,  0.5f,    0.0f, 0.0f, 1.0f,    1.0f, 0.0f,  // Bottom-right
+    -0.5f,  0.5f,  0.5f,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f,  // Top-right
+    -0.5f,  0.5f, -0.5f,    0.0f, 0.0f, 1.0f,    0.0f, 1.0f,  // Top-left
+
+    // Right face (Yellow)
+     0.5f, -0.5f, -0.5f,    1.0f, 1.0f, 0.0f,    0.0f, 0.0f,  // Bottom-left
+     0.5f, -0.5f,  0.5f,    1.0f, 1.0f, 0.0f,    1.0f, 0.0f,  // Bottom-right
+     0.5f,  0.5f,  0.5f,    1.0f, 1.0f, 0.0f,    1.0f, 1.0f,  // Top-right
+     0.5f,  0.5f, -0.5f,    1.0f, 1.0f, 0.0f,    0.0f, 1.0f,  // Top-left
+
+    // Bottom face (Cyan)
+    -0.5f, -0.5f, -0.5f,    0.0f, 1.0f, 1.0f,    0.0f, 0.0f,  // Bottom-left
+     0.5f, -0.5f, -0.5f,    0.0f, 1.0f, 1.0f,    1.0f, 0.0f,  // Bottom-right
+     0.5f, -0.5f,  0.5f,    0.0f, 1.0f, 1.0f,    1.0f, 1.0f,  // Top-right
+    -0.5f, -0.5f,  0.5f,    0.0f, 1.0f, 1.0f,    0.0f, 1.0f,  // Top-left
+
+    // Top face (Magenta/Pink)
+    -0.5f,  0.5f, -0.5f,    1.0f, 0.0f, 1.0f,    0.0f, 0.0f,  // Bottom-left
+     0.5f,  0.5f, -0.5f,    1.0f, 0.0f, 1.0f,    1.0f, 0.0f,  // Bottom-right
+     0.5f,  0.5f,  0.5f,    1.0f, 0.0f, 1.0f,    1.0f, 1.0f,  // Top-right
+    -0.5f,  0.5f,  0.5f,    1.0f, 0.0f, 1.0f,    0.0f, 1.0f,  // Top-left
+};
+
+/* Indices for cubeVertices order, every triangle counter-clockwise seen from outside so back faces can be culled */
+const unsigned int cubeIndices[] = {
+    0, 1, 2, 2, 3, 0,       // Front face
+    4, 6, 5, 6, 4, 7,       // Back face
+    8, 9, 10, 10, 11, 8,    // Left face
+    12, 14, 13, 14, 12, 15, // Right face
+    16, 17, 18, 18, 19, 16, // Bottom face
+    20, 22, 21, 22, 20, 23  // Top face
+};
+
+#endif // CUBE_GEOMETRY_H
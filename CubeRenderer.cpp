@@ -0,0 +1,117 @@
+#include "CubeRenderer.h"
+#include <Debugger.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <vector>
+
+CubeRenderer::CubeRenderer(VertexArray& va, IndexBuffer& ib, Shader& shader)
+    : va(va), ib(ib), shader(shader) {
+    va.Bind();
+    GLCall(glGenBuffers(1, &modelBuffer));
+    GLCall(glGenBuffers(1, &idBuffer));
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, modelBuffer));
+    for (unsigned int column = 0; column < 4; column++) {
+        const unsigned int location = MODEL_LOCATION + column;
+        GLCall(glEnableVertexAttribArray(location));
+        GLCall(glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                     reinterpret_cast<const void*>(column * sizeof(glm::vec4))));
+        GLCall(glVertexAttribDivisor(location, 1));
+    }
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, idBuffer));
+    GLCall(glEnableVertexAttribArray(ID_LOCATION));
+    GLCall(glVertexAttribIPointer(ID_LOCATION, 1, GL_INT, sizeof(GLint), nullptr));
+    GLCall(glVertexAttribDivisor(ID_LOCATION, 1));
+    va.Unbind();
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+    // Shader only sets uniforms by name, so the locations come from the program it binds
+    GLint program = 0;
+    shader.Bind();
+    GLCall(glGetIntegerv(GL_CURRENT_PROGRAM, &program));
+    viewProjectionLocation = glGetUniformLocation(program, "u_VP");
+    pickingLocation = glGetUniformLocation(program, "u_PickingMode");
+    GLCall(glUniform1i(glGetUniformLocation(program, "u_Texture"), 0));
+    GLCall(glUniform4f(glGetUniformLocation(program, "u_Color"), 1.0f, 1.0f, 1.0f, 1.0f));
+}
+
+CubeRenderer::~CubeRenderer() {
+    GLCall(glDeleteBuffers(1, &modelBuffer));
+    GLCall(glDeleteBuffers(1, &idBuffer));
+}
+
+// Matrices are cached between frames and only the cubies RubiksCube::getChangedCubies reports are
+// recomputed and uploaded, in runs of nearby ids, so a frame where nothing moved costs nothing
+// here; the camera only goes into the view-projection uniform. When many cubies changed (a big
+// layer turning, a reset, another cube) everything is redone in bulk by cubieMatrices, and the
+// buffer is orphaned first so the driver never waits for the previous frame's draw to finish
+// reading it. The buffer only grows, doubling, when there are more cubies. Ids are the instance
+// numbers, so their buffer is only refilled when it grows.
+void CubeRenderer::upload(const RubiksCube& cube) {
+    const CubieChanges& changes = cube.getChanges();
+    const bool sameCube = changes.serial() == uploadedSerial;
+    if (sameCube && changes.version() == uploadedVersion)
+        return;
+    const size_t count = cube.getCubes().size();
+    const glm::mat4 parent = glm::translate(glm::mat4(1.0f), CUBE_CENTER);
+
+    if (sameCube && count <= capacity && cube.getChangedCubies(uploadedVersion, changed) && changed.size() <= count / 8) {
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+        for (int id : changed)
+            models[id] = parent * cube.cubieMatrix(cube.getCubes()[id]);
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, modelBuffer));
+        for (size_t first = 0, last; first < changed.size(); first = last) {
+            for (last = first + 1; last < changed.size() && changed[last] - changed[last - 1] <= RUN_GAP; last++)
+                ;
+            const int begin = changed[first], end = changed[last - 1] + 1;
+            GLCall(glBufferSubData(GL_ARRAY_BUFFER, begin * sizeof(glm::mat4), (end - begin) * sizeof(glm::mat4), &models[begin]));
+        }
+    } else {
+        models.resize(count);
+        cube.cubieMatrices(parent, models.data());
+        if (count > capacity) {
+            capacity = std::max(count, capacity * 2);
+            std::vector<GLint> ids(capacity);
+            for (size_t i = 0; i < capacity; i++)
+                ids[i] = GLint(i);
+            GLCall(glBindBuffer(GL_ARRAY_BUFFER, idBuffer));
+            GLCall(glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(GLint), ids.data(), GL_STATIC_DRAW));
+        }
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, modelBuffer));
+        GLCall(glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW));
+        GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(glm::mat4), models.data()));
+    }
+    uploadedSerial = changes.serial();
+    uploadedVersion = changes.version();
+}
+
+void CubeRenderer::draw(const RubiksCube& cube, const glm::mat4& viewProjection, bool picking) {
+    if (cube.getCubes().size() == 0)
+        return;
+    upload(cube);
+
+    shader.Bind();
+    GLCall(glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection)));
+    if (pickingMode != int(picking)) {
+        pickingMode = int(picking);
+        GLCall(glUniform1i(pickingLocation, pickingMode));
+    }
+    submit(cube);
+}
+
+void CubeRenderer::drawWith(Shader& program, GLint viewProjectionLocation, const RubiksCube& cube, const glm::mat4& viewProjection) {
+    if (cube.getCubes().size() == 0)
+        return;
+    upload(cube);
+
+    program.Bind();
+    GLCall(glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection)));
+    submit(cube);
+}
+
+void CubeRenderer::submit(const RubiksCube& cube) {
+    va.Bind();
+    ib.Bind();
+    GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr, GLsizei(cube.getCubes().size())));
+}
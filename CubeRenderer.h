@@ -0,0 +1,58 @@
+#ifndef CUBE_RENDERER_H
+#define CUBE_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <Shader.h>
+#include <IndexBuffer.h>
+#include <VertexArray.h>
+#include "RubiksCube.h"
+
+// Where the cube sits in the world
+const glm::vec3 CUBE_CENTER(0.0f, 0.0f, -10.0f);
+
+// Draws every cubie with a single instanced draw call. The cubie mesh is the vertex array and
+// index buffer set up by main; the renderer adds two per-instance buffers to that vertex array:
+// each cubie's model matrix (attributes 3 to 6, one column each), kept up to date with only the
+// cubies that moved since the last draw, and its id (attribute 7), only written when the cubie
+// count changes. The shader derives the picking colour from the id, so the picking pass is the same
+// single draw.
+// Other programs with the same vertex inputs, such as the id pass of PickingBuffer, can draw the
+// cubies through drawWith.
+// The renderer owns the shader's uniforms: their locations are looked up once, the texture unit
+// and colour are set once, and a draw only sets the view-projection matrix and, when it changes,
+// the picking flag, with no uniform lookups by name.
+class CubeRenderer {
+public:
+    static const unsigned int MODEL_LOCATION = 3;
+    static const unsigned int ID_LOCATION = 7;
+    static const int RUN_GAP = 8; // changed ids at most this far apart are uploaded together
+
+    CubeRenderer(VertexArray& va, IndexBuffer& ib, Shader& shader);
+    ~CubeRenderer();
+    CubeRenderer(const CubeRenderer&) = delete;
+    CubeRenderer& operator=(const CubeRenderer&) = delete;
+
+    // Uploads the cubies' matrices and draws them all; picking draws id colours instead of textures
+    void draw(const RubiksCube& cube, const glm::mat4& viewProjection, bool picking = false);
+    // The same draw with another program; viewProjectionLocation is its u_VP
+    void drawWith(Shader& program, GLint viewProjectionLocation, const RubiksCube& cube, const glm::mat4& viewProjection);
+
+private:
+    void upload(const RubiksCube& cube);
+    void submit(const RubiksCube& cube);
+
+    VertexArray& va;
+    IndexBuffer& ib;
+    Shader& shader;
+    GLint viewProjectionLocation = -1, pickingLocation = -1;
+    int pickingMode = -1; // as last set, -1 before the first draw
+    GLuint modelBuffer = 0, idBuffer = 0;
+    size_t capacity = 0; // instances the buffers have storage for
+    AlignedVector<glm::mat4> models; // as uploaded
+    uint64_t uploadedSerial = 0, uploadedVersion = 0; // the cube and version models hold
+    std::vector<int> changed; // scratch for RubiksCube::getChangedCubies
+};
+
+#endif // CUBE_RENDERER_H
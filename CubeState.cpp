@@ -0,0 +1,358 @@
+#include "CubeState.h"
+#include "Orientation.h"
+#include "RubiksCube.h"
+
+namespace {
+
+struct IVec3 {
+    int x, y, z;
+    constexpr int operator[](int i) const { return i == 0 ? x : (i == 1 ? y : z); }
+    constexpr bool operator==(const IVec3& o) const { return x == o.x && y == o.y && z == o.z; }
+};
+
+constexpr IVec3 CORNER_POSITIONS[NUM_CORNERS] = {
+    { 1, 1, 1}, {-1, 1, 1}, {-1, 1,-1}, { 1, 1,-1}, // URF, UFL, ULB, UBR
+    { 1,-1, 1}, {-1,-1, 1}, {-1,-1,-1}, { 1,-1,-1}  // DFR, DLF, DBL, DRB
+};
+
+constexpr IVec3 EDGE_POSITIONS[NUM_EDGES] = {
+    { 1, 1, 0}, { 0, 1, 1}, {-1, 1, 0}, { 0, 1,-1}, // UR, UF, UL, UB
+    { 1,-1, 0}, { 0,-1, 1}, {-1,-1, 0}, { 0,-1,-1}, // DR, DF, DL, DB
+    { 1, 0, 1}, {-1, 0, 1}, {-1, 0,-1}, { 1, 0,-1}  // FR, FL, BL, BR
+};
+
+// Rotate by quarterTurns * 90 degrees about the positive axis (right-handed, like glm::rotate)
+constexpr IVec3 rotateQuarter(IVec3 v, int axis, int quarterTurns) {
+    for (int i = 0; i < (quarterTurns & 3); i++) {
+        if (axis == 0) v = {v.x, -v.z, v.y};
+        else if (axis == 1) v = {v.z, v.y, -v.x};
+        else v = {-v.y, v.x, v.z};
+    }
+    return v;
+}
+
+constexpr bool onFace(IVec3 v, int face) {
+    return v[face / 2] == ((face == 0 || face == 2 || face == 5) ? 1 : -1);
+}
+
+constexpr int axisOf(IVec3 v) { return v.x != 0 ? 0 : (v.y != 0 ? 1 : 2); }
+
+// Twist of a corner at slot position p whose reference (home up/down) sticker points along axis
+constexpr int cornerTwistFromAxis(IVec3 p, int axis) {
+    if (axis == 1) return 0;
+    bool positive = p.x * p.y * p.z > 0; // clockwise order seen from outside is y, x, z on positive corners
+    return (axis == 0) == positive ? 1 : 2;
+}
+
+constexpr int edgeReferenceAxis(IVec3 p) { return p.y != 0 ? 1 : 2; }
+
+template <int N>
+constexpr int slotIndex(const IVec3 (&positions)[N], IVec3 p) {
+    for (int i = 0; i < N; i++)
+        if (positions[i] == p) return i;
+    return -1;
+}
+
+struct MoveTables {
+    // For every move: the 4 corner/edge slots of the face, where their cubies go,
+    // and the orientation change picked up on the way
+    uint8_t cornerFrom[NUM_MOVES][4] = {};
+    uint8_t cornerTo[NUM_MOVES][4] = {};
+    uint8_t cornerTwist[NUM_MOVES][4] = {};
+    uint8_t edgeFrom[NUM_MOVES][4] = {};
+    uint8_t edgeTo[NUM_MOVES][4] = {};
+    uint8_t edgeFlip[NUM_MOVES][4] = {};
+    uint64_t cornerMask[NUM_MOVES] = {};
+    uint64_t edgeMask[NUM_MOVES] = {};
+};
+
+constexpr MoveTables buildMoveTables() {
+    MoveTables t;
+    for (int move = 0; move < NUM_MOVES; move++) {
+        int face = moveFace(move), axis = moveAxis(move), q = moveQuarterTurns(move);
+        int n = 0;
+        for (int i = 0; i < NUM_CORNERS; i++) {
+            IVec3 p = CORNER_POSITIONS[i];
+            if (!onFace(p, face)) continue;
+            IVec3 to = rotateQuarter(p, axis, q);
+            IVec3 sticker = rotateQuarter(IVec3{0, p.y, 0}, axis, q);
+            t.cornerFrom[move][n] = i;
+            t.cornerTo[move][n] = slotIndex(CORNER_POSITIONS, to);
+            t.cornerTwist[move][n] = cornerTwistFromAxis(to, axisOf(sticker));
+            t.cornerMask[move] |= uint64_t(31) << (5 * slotIndex(CORNER_POSITIONS, to));
+            n++;
+        }
+        n = 0;
+        for (int i = 0; i < NUM_EDGES; i++) {
+            IVec3 p = EDGE_POSITIONS[i];
+            if (!onFace(p, face)) continue;
+            IVec3 to = rotateQuarter(p, axis, q);
+            int refAxis = edgeReferenceAxis(p);
+            IVec3 sticker = rotateQuarter(IVec3{0, refAxis == 1 ? p.y : 0, refAxis == 2 ? p.z : 0}, axis, q);
+            t.edgeFrom[move][n] = i;
+            t.edgeTo[move][n] = slotIndex(EDGE_POSITIONS, to);
+            t.edgeFlip[move][n] = axisOf(sticker) != edgeReferenceAxis(to);
+            t.edgeMask[move] |= uint64_t(31) << (5 * slotIndex(EDGE_POSITIONS, to));
+            n++;
+        }
+    }
+    return t;
+}
+
+constexpr MoveTables MOVE_TABLES = buildMoveTables();
+
+// A cubie's orientation as an integer matrix (row major), to read twists and flips off
+struct IMat3 {
+    int m[3][3];
+    IVec3 apply(IVec3 v) const {
+        return {m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+                m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+                m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z};
+    }
+};
+
+IMat3 orientationIMat3(uint8_t orientation) {
+    IMat3 r;
+    for (int row = 0; row < 3; row++)
+        for (int col = 0; col < 3; col++)
+            r.m[row][col] = ORIENTATION_TABLES.matrices[orientation][row][col];
+    return r;
+}
+
+// Grid position of 3x3x3 cubie id (or surface slot) from the center, the inverse of cubeId below
+IVec3 gridPosition(int id) {
+    int grid = id >= 13 ? id + 1 : id;
+    return {grid / 9 - 1, grid / 3 % 3 - 1, grid % 3 - 1};
+}
+
+IVec3 centerPosition(int face) {
+    int sign = (face == 0 || face == 2 || face == 5) ? 1 : -1;
+    return {face / 2 == 0 ? sign : 0, face / 2 == 1 ? sign : 0, face / 2 == 2 ? sign : 0};
+}
+
+// RubiksCube id of the cubie whose home is p: grid order with the hidden core (13) left out
+int cubeId(IVec3 p) {
+    int grid = (p.x + 1) * 9 + (p.y + 1) * 3 + (p.z + 1);
+    return grid > 13 ? grid - 1 : grid;
+}
+
+int cornerTwistOf(const IMat3& r, IVec3 home, IVec3 slot) {
+    return cornerTwistFromAxis(slot, axisOf(r.apply(IVec3{0, home.y, 0})));
+}
+
+int edgeFlipOf(const IMat3& r, IVec3 home, IVec3 slot) {
+    int refAxis = edgeReferenceAxis(home);
+    IVec3 sticker = r.apply(IVec3{0, refAxis == 1 ? home.y : 0, refAxis == 2 ? home.z : 0});
+    return axisOf(sticker) != edgeReferenceAxis(slot);
+}
+
+int centerTurnsOf(const IMat3& r, int face) {
+    int axis = face / 2;
+    const IVec3 probes[3] = {{0, 1, 0}, {0, 0, 1}, {1, 0, 0}}; // any vector perpendicular to the axis
+    IVec3 probe = probes[axis];
+    IVec3 turned = r.apply(probe);
+    for (int q = 0; q < 4; q++)
+        if (rotateQuarter(probe, axis, q) == turned) return q;
+    return -1;
+}
+
+} // namespace
+
+CubeState CubeState::solved() {
+    CubeState state{0, 0};
+    for (int i = 0; i < NUM_CORNERS; i++) state.corners |= uint64_t(i) << (5 * i);
+    for (int i = 0; i < NUM_EDGES; i++) state.edges |= uint64_t(i) << (5 * i);
+    return state;
+}
+
+void CubeState::setCorner(int slot, int cubie, int twist) {
+    corners &= ~(uint64_t(31) << (5 * slot));
+    corners |= uint64_t(cubie | twist << 3) << (5 * slot);
+}
+
+void CubeState::setEdge(int slot, int cubie, int flip) {
+    edges &= ~(uint64_t(31) << (5 * slot));
+    edges |= uint64_t(cubie | flip << 4) << (5 * slot);
+}
+
+void CubeState::setCenterTurns(int face, int turns) {
+    corners &= ~(uint64_t(3) << (40 + 2 * face));
+    corners |= uint64_t(turns & 3) << (40 + 2 * face);
+}
+
+void CubeState::applyMove(int move) {
+    const MoveTables& t = MOVE_TABLES;
+    uint64_t newCorners = corners & ~t.cornerMask[move];
+    uint64_t newEdges = edges & ~t.edgeMask[move];
+    for (int k = 0; k < 4; k++) {
+        uint64_t corner = (corners >> (5 * t.cornerFrom[move][k])) & 31;
+        corner += uint64_t(t.cornerTwist[move][k]) << 3;
+        corner -= (corner >= 24) * 24; // twist mod 3
+        newCorners |= corner << (5 * t.cornerTo[move][k]);
+
+        uint64_t edge = (edges >> (5 * t.edgeFrom[move][k])) & 31;
+        edge ^= uint64_t(t.edgeFlip[move][k]) << 4;
+        newEdges |= edge << (5 * t.edgeTo[move][k]);
+    }
+    int face = moveFace(move);
+    uint64_t centerShift = 40 + 2 * face;
+    uint64_t turns = ((corners >> centerShift) + moveQuarterTurns(move)) & 3;
+    corners = (newCorners & ~(uint64_t(3) << centerShift)) | (turns << centerShift);
+    edges = newEdges;
+}
+
+bool CubeState::isSolved() const {
+    const CubeState goal = solved();
+    const uint64_t cubieMask = (uint64_t(1) << 40) - 1;
+    return (corners & cubieMask) == goal.corners && edges == goal.edges;
+}
+
+bool CubeState::isValid() const {
+    int seenCorners = 0, seenEdges = 0, twist = 0, flip = 0, parity = 0;
+    int cornerPerm[NUM_CORNERS], edgePerm[NUM_EDGES];
+    for (int i = 0; i < NUM_CORNERS; i++) {
+        cornerPerm[i] = cornerCubie(i);
+        if (cornerTwist(i) > 2) return false;
+        seenCorners |= 1 << cornerPerm[i];
+        twist += cornerTwist(i);
+    }
+    for (int i = 0; i < NUM_EDGES; i++) {
+        edgePerm[i] = edgeCubie(i);
+        if (edgePerm[i] >= NUM_EDGES) return false;
+        seenEdges |= 1 << edgePerm[i];
+        flip += edgeFlip(i);
+    }
+    if (seenCorners != 0xFF || seenEdges != 0xFFF || twist % 3 != 0 || flip % 2 != 0)
+        return false;
+    for (int i = 0; i < NUM_CORNERS; i++)
+        for (int j = i + 1; j < NUM_CORNERS; j++)
+            parity ^= cornerPerm[i] > cornerPerm[j];
+    for (int i = 0; i < NUM_EDGES; i++)
+        for (int j = i + 1; j < NUM_EDGES; j++)
+            parity ^= edgePerm[i] > edgePerm[j];
+    return parity == 0;
+}
+
+CubeState CubeState::inverse() const {
+    CubeState inverted{corners & ~((uint64_t(1) << 40) - 1), 0};
+    for (int i = 0; i < NUM_CORNERS; i++)
+        inverted.setCorner(cornerCubie(i), i, (3 - cornerTwist(i)) % 3);
+    for (int i = 0; i < NUM_EDGES; i++)
+        inverted.setEdge(edgeCubie(i), i, edgeFlip(i));
+    for (int face = 0; face < NUM_FACES; face++)
+        inverted.setCenterTurns(face, 4 - centerTurns(face));
+    return inverted;
+}
+
+CubeState CubeState::transformed(const int (&matrix)[3][3]) const {
+    IMat3 m, mInverse; // signed permutation matrices are orthogonal: the inverse is the transpose
+    for (int row = 0; row < 3; row++)
+        for (int col = 0; col < 3; col++) {
+            m.m[row][col] = matrix[row][col];
+            mInverse.m[col][row] = matrix[row][col];
+        }
+    auto conjugate = [&](const IMat3& r) {
+        IMat3 product{}, result{};
+        for (int row = 0; row < 3; row++)
+            for (int col = 0; col < 3; col++)
+                for (int k = 0; k < 3; k++)
+                    product.m[row][col] += r.m[row][k] * mInverse.m[k][col];
+        for (int row = 0; row < 3; row++)
+            for (int col = 0; col < 3; col++)
+                for (int k = 0; k < 3; k++)
+                    result.m[row][col] += m.m[row][k] * product.m[k][col];
+        return result;
+    };
+
+    CubeState result{0, 0};
+    for (int face = 0; face < NUM_FACES; face++) {
+        IVec3 p = centerPosition(face), to = m.apply(p);
+        int toFace = 0;
+        while (!(centerPosition(toFace) == to)) toFace++;
+        for (int o = 0; o < 24; o++) {
+            IMat3 r = orientationIMat3(uint8_t(o));
+            if (r.apply(p) == p && centerTurnsOf(r, face) == centerTurns(face))
+                result.setCenterTurns(toFace, centerTurnsOf(conjugate(r), toFace));
+        }
+    }
+    for (int i = 0; i < NUM_CORNERS; i++) {
+        IVec3 home = CORNER_POSITIONS[cornerCubie(i)], slot = CORNER_POSITIONS[i];
+        IVec3 toHome = m.apply(home), toSlot = m.apply(slot);
+        for (int o = 0; o < 24; o++) {
+            IMat3 r = orientationIMat3(uint8_t(o));
+            if (r.apply(home) == slot && cornerTwistOf(r, home, slot) == cornerTwist(i))
+                result.setCorner(slotIndex(CORNER_POSITIONS, toSlot), slotIndex(CORNER_POSITIONS, toHome),
+                                 cornerTwistOf(conjugate(r), toHome, toSlot));
+        }
+    }
+    for (int i = 0; i < NUM_EDGES; i++) {
+        IVec3 home = EDGE_POSITIONS[edgeCubie(i)], slot = EDGE_POSITIONS[i];
+        IVec3 toHome = m.apply(home), toSlot = m.apply(slot);
+        for (int o = 0; o < 24; o++) {
+            IMat3 r = orientationIMat3(uint8_t(o));
+            if (r.apply(home) == slot && edgeFlipOf(r, home, slot) == edgeFlip(i))
+                result.setEdge(slotIndex(EDGE_POSITIONS, toSlot), slotIndex(EDGE_POSITIONS, toHome),
+                               edgeFlipOf(conjugate(r), toHome, toSlot));
+        }
+    }
+    return result;
+}
+
+bool CubeState::fromCubes(const CubieArrays& cubes, CubeState& state) {
+    if (cubes.size() != 26)
+        return false;
+    state = CubeState{0, 0};
+    int filledCorners = 0, filledEdges = 0;
+    for (const Cube& cubie : cubes) {
+        if (cubie.id < 0 || cubie.id >= 26 || cubie.slot < 0 || cubie.slot >= 26 || cubie.orientation >= 24)
+            return false;
+        IMat3 r = orientationIMat3(cubie.orientation);
+        IVec3 home = gridPosition(cubie.id);
+        IVec3 slot = gridPosition(cubie.slot);
+        if (!(r.apply(home) == slot))
+            return false;
+        int nonZero = (home.x != 0) + (home.y != 0) + (home.z != 0);
+        if (nonZero == 3) {
+            int i = slotIndex(CORNER_POSITIONS, slot);
+            state.setCorner(i, slotIndex(CORNER_POSITIONS, home), cornerTwistOf(r, home, slot));
+            filledCorners |= 1 << i;
+        } else if (nonZero == 2) {
+            int i = slotIndex(EDGE_POSITIONS, slot);
+            state.setEdge(i, slotIndex(EDGE_POSITIONS, home), edgeFlipOf(r, home, slot));
+            filledEdges |= 1 << i;
+        } else {
+            int face = 0;
+            while (!(centerPosition(face) == home)) face++;
+            state.setCenterTurns(face, centerTurnsOf(r, face));
+        }
+    }
+    return filledCorners == 0xFF && filledEdges == 0xFFF && state.isValid();
+}
+
+void CubeState::toCubes(CubieArrays& cubes) const {
+    cubes.reset(26);
+    for (int face = 0; face < NUM_FACES; face++) {
+        IVec3 p = centerPosition(face);
+        for (int o = 0; o < 24; o++) {
+            IMat3 r = orientationIMat3(uint8_t(o));
+            if (r.apply(p) == p && centerTurnsOf(r, face) == centerTurns(face))
+                cubes.set(cubeId(p), cubeId(p), uint8_t(o));
+        }
+    }
+    for (int i = 0; i < NUM_CORNERS; i++) {
+        IVec3 home = CORNER_POSITIONS[cornerCubie(i)], slot = CORNER_POSITIONS[i];
+        for (int o = 0; o < 24; o++) {
+            IMat3 r = orientationIMat3(uint8_t(o));
+            if (r.apply(home) == slot && cornerTwistOf(r, home, slot) == cornerTwist(i))
+                cubes.set(cubeId(home), cubeId(slot), uint8_t(o));
+        }
+    }
+    for (int i = 0; i < NUM_EDGES; i++) {
+        IVec3 home = EDGE_POSITIONS[edgeCubie(i)], slot = EDGE_POSITIONS[i];
+        for (int o = 0; o < 24; o++) {
+            IMat3 r = orientationIMat3(uint8_t(o));
+            if (r.apply(home) == slot && edgeFlipOf(r, home, slot) == edgeFlip(i))
+                cubes.set(cubeId(home), cubeId(slot), uint8_t(o));
+        }
+    }
+}
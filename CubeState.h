@@ -0,0 +1,80 @@
+#ifndef CUBESTATE_H
+#define CUBESTATE_H
+
+#include <cstdint>
+#include <vector>
+
+class CubieArrays;
+
+// Faces use the RubiksCube numbering: right = 0, left = 1, up = 2, down = 3, back = 4, front = 5.
+// A move is indexed face * 3 + (quarterTurns - 1), where quarterTurns counts 90 degree steps
+// about the positive axis of the face (x for right/left, y for up/down, z for back/front),
+// which is the same sign convention as the angle passed to RubiksCube::rotateFace.
+constexpr int NUM_FACES = 6;
+constexpr int NUM_MOVES = 18;
+constexpr int NUM_CORNERS = 8;
+constexpr int NUM_EDGES = 12;
+
+constexpr int makeMove(int face, int quarterTurns) { return face * 3 + (quarterTurns & 3) - 1; } // quarterTurns % 4 != 0
+constexpr int moveFace(int move) { return move / 3; }
+constexpr int moveAxis(int move) { return move / 6; } // x = 0, y = 1, z = 2
+constexpr int moveQuarterTurns(int move) { return move % 3 + 1; }
+constexpr int inverseMove(int move) { return move + 2 - 2 * (move % 3); }
+
+// Searches never turn the same face twice in a row, and turn opposite faces in one order only
+constexpr bool isRedundantAfter(int lastFace, int face) {
+    return face == lastFace || (face / 2 == lastFace / 2 && face < lastFace);
+}
+
+// Packed 3x3x3 state: cubie permutation and orientation for every corner and edge slot,
+// plus the quarter-turn count of the six face centres (they never move, but they do spin,
+// and the renderer shows it).
+//
+// Corner slots: URF, UFL, ULB, UBR, DFR, DLF, DBL, DRB.
+// Edge slots:   UR, UF, UL, UB, DR, DF, DL, DB, FR, FL, BL, BR.
+// Corner twist is measured on the sticker that faces up/down when the cubie is home,
+// edge flip on the up/down sticker (front/back for the middle layer edges), so only
+// front/back quarter turns flip edges and up/down turns never twist corners.
+struct CubeState {
+    uint64_t corners; // 8 x 5 bits (cubie | twist << 3), centre quarter turns 2 bits per face from bit 40
+    uint64_t edges;   // 12 x 5 bits (cubie | flip << 4)
+
+    static CubeState solved();
+
+    int cornerCubie(int slot) const { return (corners >> (5 * slot)) & 7; }
+    int cornerTwist(int slot) const { return (corners >> (5 * slot + 3)) & 3; }
+    int edgeCubie(int slot) const { return (edges >> (5 * slot)) & 15; }
+    int edgeFlip(int slot) const { return (edges >> (5 * slot + 4)) & 1; }
+    int centerTurns(int face) const { return (corners >> (40 + 2 * face)) & 3; }
+
+    void setCorner(int slot, int cubie, int twist);
+    void setEdge(int slot, int cubie, int flip);
+    void setCenterTurns(int face, int turns);
+
+    void applyMove(int move);
+    void applyTurn(int face, int quarterTurns) { if (quarterTurns & 3) applyMove(makeMove(face, quarterTurns)); }
+
+    // Corners and edges solved; centre spin is ignored
+    bool isSolved() const;
+    // Permutations, parities and orientation sums describe a reachable cube
+    bool isValid() const;
+
+    // The state that undoes this one, reached by this state's moves reversed and inverted
+    CubeState inverse() const;
+    // The state carried by a symmetry of the cube: every cubie's slot, home and rotation mapped
+    // through matrix, a signed permutation matrix (row major, determinant +1 or -1), so that
+    // transformed(M) is M * this * M^-1. Works on any packed state whose cubie numbers are in
+    // range, reachable or not.
+    CubeState transformed(const int (&matrix)[3][3]) const;
+
+    bool operator==(const CubeState& other) const { return corners == other.corners && edges == other.edges; }
+    bool operator!=(const CubeState& other) const { return !(*this == other); }
+
+    // Conversion to and from the renderer's cubies, the 26 surface cubies of a 3x3x3 RubiksCube.
+    // fromCubes fails (returns false) when the cubies' slots and orientations are not a legal
+    // face-turn state.
+    static bool fromCubes(const CubieArrays& cubes, CubeState& state);
+    void toCubes(CubieArrays& cubes) const;
+};
+
+#endif // CUBESTATE_H
@@ -0,0 +1,200 @@
+#include "CubeSymmetry.h"
+#include "Orientation.h"
+#include "RubiksCube.h"
+#include <algorithm>
+
+namespace {
+
+struct SymmetryTables {
+    int matrices[SYMMETRY_COUNT][3][3];
+    uint8_t products[SYMMETRY_COUNT][SYMMETRY_COUNT]; // products[a][b]: b, then a
+    uint8_t inverses[SYMMETRY_COUNT];
+    uint8_t moves[SYMMETRY_COUNT][NUM_MOVES];
+    uint8_t faces[SYMMETRY_COUNT][NUM_FACES];
+    // Where a slot's contents go, and what the packed value at the slot becomes
+    // (corner: cubie | twist << 3, edge: cubie | flip << 4, centre: quarter turns)
+    uint8_t cornerTo[SYMMETRY_COUNT][NUM_CORNERS];
+    uint8_t cornerValues[SYMMETRY_COUNT][NUM_CORNERS][32];
+    uint8_t edgeTo[SYMMETRY_COUNT][NUM_EDGES];
+    uint8_t edgeValues[SYMMETRY_COUNT][NUM_EDGES][32];
+    uint8_t centerTurns[SYMMETRY_COUNT][NUM_FACES][4];
+};
+
+const uint64_t CUBIE_MASK = (uint64_t(1) << 40) - 1; // corner bits, without the centre spin
+
+int faceOf(const int (&v)[3]) {
+    for (int axis = 0; axis < 3; axis++)
+        if (v[axis] != 0)
+            return 2 * axis + (axis == 2 ? v[axis] > 0 : v[axis] < 0); // R L U D B F
+    return -1;
+}
+
+SymmetryTables buildTables() {
+    SymmetryTables t{};
+    for (int s = 0; s < SYMMETRY_COUNT; s++)
+        for (int row = 0; row < 3; row++)
+            for (int col = 0; col < 3; col++)
+                t.matrices[s][row][col] = (s < 24 ? 1 : -1) * ORIENTATION_TABLES.matrices[s % 24][row][col];
+    // The central inversion commutes with every rotation
+    for (int a = 0; a < SYMMETRY_COUNT; a++)
+        for (int b = 0; b < SYMMETRY_COUNT; b++)
+            t.products[a][b] = uint8_t(ORIENTATION_TABLES.products[a % 24][b % 24] + 24 * ((a >= 24) != (b >= 24)));
+    for (int s = 0; s < SYMMETRY_COUNT; s++)
+        for (int inverse = 0; inverse < SYMMETRY_COUNT; inverse++)
+            if (t.products[s][inverse] == 0)
+                t.inverses[s] = uint8_t(inverse);
+
+    for (int s = 0; s < SYMMETRY_COUNT; s++) {
+        const auto& m = t.matrices[s];
+        const int determinant = s < 24 ? 1 : -1;
+        for (int face = 0; face < NUM_FACES; face++) {
+            const int axis = face / 2, sign = face == 0 || face == 2 || face == 5 ? 1 : -1;
+            const int normal[3] = {m[0][axis] * sign, m[1][axis] * sign, m[2][axis] * sign};
+            t.faces[s][face] = uint8_t(faceOf(normal));
+            // A quarter turn about the positive axis becomes one about the image of that axis,
+            // the other way round under a reflection
+            const int image[3] = {m[0][axis], m[1][axis], m[2][axis]};
+            const int imageSign = image[0] + image[1] + image[2];
+            for (int q = 1; q <= 3; q++)
+                t.moves[s][makeMove(face, q)] = uint8_t(makeMove(t.faces[s][face], q * determinant * imageSign));
+        }
+
+        // Probe states holding the same cubie in every slot show what each slot's value becomes;
+        // transformed() does not need a reachable state. A slot goes where its home cubie goes.
+        CubeState cornerProbes[3][NUM_CORNERS], edgeProbes[2][NUM_EDGES];
+        for (int twist = 0; twist < 3; twist++)
+            for (int cubie = 0; cubie < NUM_CORNERS; cubie++) {
+                CubeState probe = CubeState::solved();
+                for (int i = 0; i < NUM_CORNERS; i++)
+                    probe.setCorner(i, cubie, twist);
+                cornerProbes[twist][cubie] = probe.transformed(m);
+                t.cornerTo[s][cubie] = uint8_t(cornerProbes[twist][cubie].cornerCubie(0));
+            }
+        for (int twist = 0; twist < 3; twist++)
+            for (int cubie = 0; cubie < NUM_CORNERS; cubie++)
+                for (int i = 0; i < NUM_CORNERS; i++) {
+                    const CubeState& image = cornerProbes[twist][cubie];
+                    const int to = t.cornerTo[s][i];
+                    t.cornerValues[s][i][cubie | twist << 3] = uint8_t(image.cornerCubie(to) | image.cornerTwist(to) << 3);
+                }
+        for (int flip = 0; flip < 2; flip++)
+            for (int cubie = 0; cubie < NUM_EDGES; cubie++) {
+                CubeState probe = CubeState::solved();
+                for (int i = 0; i < NUM_EDGES; i++)
+                    probe.setEdge(i, cubie, flip);
+                edgeProbes[flip][cubie] = probe.transformed(m);
+                t.edgeTo[s][cubie] = uint8_t(edgeProbes[flip][cubie].edgeCubie(0));
+            }
+        for (int flip = 0; flip < 2; flip++)
+            for (int cubie = 0; cubie < NUM_EDGES; cubie++)
+                for (int i = 0; i < NUM_EDGES; i++) {
+                    const CubeState& image = edgeProbes[flip][cubie];
+                    const int to = t.edgeTo[s][i];
+                    t.edgeValues[s][i][cubie | flip << 4] = uint8_t(image.edgeCubie(to) | image.edgeFlip(to) << 4);
+                }
+        for (int turns = 0; turns < 4; turns++) {
+            CubeState probe = CubeState::solved();
+            for (int face = 0; face < NUM_FACES; face++)
+                probe.setCenterTurns(face, turns);
+            CubeState image = probe.transformed(m);
+            for (int face = 0; face < NUM_FACES; face++)
+                t.centerTurns[s][face][turns] = uint8_t(image.centerTurns(t.faces[s][face]));
+        }
+    }
+    return t;
+}
+
+const SymmetryTables& tables() {
+    static const SymmetryTables built = buildTables();
+    return built;
+}
+
+uint64_t conjugateCorners(const SymmetryTables& t, uint64_t corners, int symmetry) {
+    uint64_t result = 0;
+    for (int i = 0; i < NUM_CORNERS; i++)
+        result |= uint64_t(t.cornerValues[symmetry][i][(corners >> (5 * i)) & 31]) << (5 * t.cornerTo[symmetry][i]);
+    return result;
+}
+
+uint64_t conjugateEdges(const SymmetryTables& t, uint64_t edges, int symmetry) {
+    uint64_t result = 0;
+    for (int i = 0; i < NUM_EDGES; i++)
+        result |= uint64_t(t.edgeValues[symmetry][i][(edges >> (5 * i)) & 31]) << (5 * t.edgeTo[symmetry][i]);
+    return result;
+}
+
+} // namespace
+
+int composeSymmetries(int a, int b) {
+    return tables().products[a][b];
+}
+
+int inverseSymmetry(int symmetry) {
+    return tables().inverses[symmetry];
+}
+
+int conjugateMove(int move, int symmetry) {
+    return tables().moves[symmetry][move];
+}
+
+void conjugateMoves(std::vector<int>& moves, int symmetry) {
+    const uint8_t* table = tables().moves[symmetry];
+    for (int& move : moves)
+        move = table[move];
+}
+
+CubeState conjugate(const CubeState& state, int symmetry) {
+    const SymmetryTables& t = tables();
+    CubeState result{conjugateCorners(t, state.corners & CUBIE_MASK, symmetry), conjugateEdges(t, state.edges, symmetry)};
+    if (state.corners & ~CUBIE_MASK)
+        for (int face = 0; face < NUM_FACES; face++)
+            result.setCenterTurns(t.faces[symmetry][face], t.centerTurns[symmetry][face][state.centerTurns(face)]);
+    return result;
+}
+
+// Edges decide most comparisons, so corners are only conjugated when the edges tie or win
+SymmetryReduction reduceBySymmetry(const CubeState& state, bool useInverse) {
+    const SymmetryTables& t = tables();
+    const CubeState cubies{state.corners & CUBIE_MASK, state.edges};
+    SymmetryReduction best = {cubies, 0, false};
+    for (int inverted = 0; inverted <= int(useInverse); inverted++) {
+        const CubeState start = inverted ? cubies.inverse() : cubies;
+        for (int s = 0; s < SYMMETRY_COUNT; s++) {
+            const uint64_t edges = conjugateEdges(t, start.edges, s);
+            if (edges > best.representative.edges)
+                continue;
+            const uint64_t corners = conjugateCorners(t, start.corners, s);
+            if (edges < best.representative.edges || corners < best.representative.corners)
+                best = {CubeState{corners, edges}, s, inverted != 0};
+        }
+    }
+    return best;
+}
+
+bool reduceBySymmetry(const RubiksCube& cube, SymmetryReduction& reduction, bool useInverse) {
+    CubeState state;
+    if (!cube.getState(state))
+        return false;
+    reduction = reduceBySymmetry(state, useInverse);
+    return true;
+}
+
+// The inverse is solved by the moves that reach the state, undone in reverse
+void reduceSolution(const SymmetryReduction& reduction, std::vector<int>& moves) {
+    if (reduction.inverted) {
+        std::reverse(moves.begin(), moves.end());
+        for (int& move : moves)
+            move = inverseMove(move);
+    }
+    conjugateMoves(moves, reduction.symmetry);
+}
+
+void unreduceSolution(const SymmetryReduction& reduction, std::vector<int>& moves) {
+    conjugateMoves(moves, inverseSymmetry(reduction.symmetry));
+    if (reduction.inverted) {
+        // The moves reach the inverse from solved, so undoing them in reverse solves the state
+        std::reverse(moves.begin(), moves.end());
+        for (int& move : moves)
+            move = inverseMove(move);
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef CUBESYMMETRY_H
+#define CUBESYMMETRY_H
+
+#include <vector>
+#include "CubeState.h"
+
+class RubiksCube;
+
+// The 48 symmetries of the cube and state reduction by them. Symmetry s < 24 is rotation s of
+// Orientation.h (0 is the identity); s >= 24 is rotation s - 24 followed by the central
+// inversion x -> -x, which makes the 24 reflections. A symmetry acts on a state by conjugation,
+// S * state * S^-1: the whole cube is carried by S, so a state reached by some moves is carried
+// to the state reached by the carried moves.
+//
+// States related by a symmetry, or by a symmetry and inversion, are equally far from solved and
+// their solutions translate into each other, so a table or cache keyed by the class representative
+// needs up to 96 times fewer entries. Conjugation is table driven (20 lookups); the tables are
+// built from CubeState::transformed on first use.
+constexpr int SYMMETRY_COUNT = 48;
+
+int composeSymmetries(int a, int b); // a after b
+int inverseSymmetry(int symmetry);
+
+int conjugateMove(int move, int symmetry);
+void conjugateMoves(std::vector<int>& moves, int symmetry);
+CubeState conjugate(const CubeState& state, int symmetry);
+
+// The representative of a state's class: the smallest conjugate (by edges, then corners) of the
+// state, and of its inverse when useInverse is set. Centre spin is left out of the representative.
+struct SymmetryReduction {
+    CubeState representative;
+    int symmetry;  // representative = conjugate(inverted ? state.inverse() : state, symmetry)
+    bool inverted;
+};
+
+SymmetryReduction reduceBySymmetry(const CubeState& state, bool useInverse = true);
+// False while a face of the cube is mid-turn
+bool reduceBySymmetry(const RubiksCube& cube, SymmetryReduction& reduction, bool useInverse = true);
+// Turn moves that solve the original state into moves that solve reduction.representative, and back
+void reduceSolution(const SymmetryReduction& reduction, std::vector<int>& moves);
+void unreduceSolution(const SymmetryReduction& reduction, std::vector<int>& moves);
+
+#endif // CUBESYMMETRY_H
@@ -0,0 +1,89 @@
+#include "CubieArrays.h"
+#include "Orientation.h"
+#include <glm/gtc/type_ptr.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define CUBIE_ARRAYS_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+// Writes out[id] for one m: the 24 rotated matrices and m's columns are set up once
+class Transformer {
+public:
+    Transformer(const glm::mat4& m, const glm::vec4* centres, const int32_t* slots, const uint8_t* orientations, glm::mat4* out)
+        : m(m), centres(centres), slots(slots), orientations(orientations), out(out) {
+        for (int o = 0; o < 24; o++)
+            rotated[o] = m * orientationMatrix(uint8_t(o));
+#ifdef CUBIE_ARRAYS_SSE
+        for (int column = 0; column < 4; column++)
+            columns[column] = _mm_loadu_ps(glm::value_ptr(m[column]));
+#endif
+    }
+
+    void operator()(int id) const {
+        const glm::mat4& rotation = rotated[orientations[id]];
+        const glm::vec4& centre = centres[slots[id]];
+#ifdef CUBIE_ARRAYS_SSE
+        float* target = glm::value_ptr(out[id]);
+        const float* source = glm::value_ptr(rotation);
+        _mm_storeu_ps(target, _mm_loadu_ps(source));
+        _mm_storeu_ps(target + 4, _mm_loadu_ps(source + 4));
+        _mm_storeu_ps(target + 8, _mm_loadu_ps(source + 8));
+        __m128 translation = _mm_add_ps(columns[3], _mm_mul_ps(columns[0], _mm_set1_ps(centre.x)));
+        translation = _mm_add_ps(translation, _mm_mul_ps(columns[1], _mm_set1_ps(centre.y)));
+        translation = _mm_add_ps(translation, _mm_mul_ps(columns[2], _mm_set1_ps(centre.z)));
+        _mm_storeu_ps(target + 12, translation);
+#else
+        glm::mat4& target = out[id];
+        target[0] = rotation[0];
+        target[1] = rotation[1];
+        target[2] = rotation[2];
+        target[3] = m[3] + m[0] * centre.x + m[1] * centre.y + m[2] * centre.z;
+#endif
+    }
+
+private:
+    const glm::mat4& m;
+    const glm::vec4* centres;
+    const int32_t* slots;
+    const uint8_t* orientations;
+    glm::mat4* out;
+    glm::mat4 rotated[24];
+#ifdef CUBIE_ARRAYS_SSE
+    __m128 columns[4];
+#endif
+};
+
+} // namespace
+
+void CubieArrays::reset(int count) {
+    slots.resize(count);
+    orientations.assign(count, 0);
+    for (int id = 0; id < count; id++)
+        slots[id] = id;
+}
+
+void CubieArrays::turnLayer(const SlotIndex::Layer& layer, int axis, int quarterTurns) {
+    const uint8_t* turned = ORIENTATION_TABLES.products[ORIENTATION_TABLES.quarterTurns[axis][quarterTurns & 3]];
+    int32_t* slotOf = slots.data();
+    uint8_t* orientationOf = orientations.data();
+    for (int i = 0; i < layer.size(); i++) {
+        const int id = layer[i];
+        slotOf[id] = layer.slotAt(i);
+        orientationOf[id] = turned[orientationOf[id]];
+    }
+}
+
+void CubieArrays::transform(const glm::mat4& m, const glm::vec4* centres, glm::mat4* out) const {
+    Transformer transformer(m, centres, slots.data(), orientations.data(), out);
+    for (int id = 0; id < int(size()); id++)
+        transformer(id);
+}
+
+void CubieArrays::transform(const glm::mat4& m, const glm::vec4* centres, const SlotIndex::Layer& layer, glm::mat4* out) const {
+    Transformer transformer(m, centres, slots.data(), orientations.data(), out);
+    for (int id : layer)
+        transformer(id);
+}
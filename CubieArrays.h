@@ -0,0 +1,108 @@
+#ifndef CUBIEARRAYS_H
+#define CUBIEARRAYS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "SlotIndex.h"
+
+// Define the Cube structure
+// Only the settled state is stored, exactly: the slot the cubie sits in and its orientation. Where
+// it is drawn, including a layer turn in progress, comes from RubiksCube::cubieMatrix.
+struct Cube {
+    int id;                  // also the slot the cubie is solved in
+    int slot;                // as of the last settled turn of its layers
+    uint8_t orientation = 0; // rotation from the solved orientation, see Orientation.h
+
+    std::string toString() const {
+        std::ostringstream oss;
+        oss << "Cube ID: " << id << "\n";
+        oss << "Slot: " << slot << "\n";
+        oss << "Orientation: " << int(orientation) << "\n";
+        return oss.str();
+    }   
+
+};
+
+// std::vector storage starting on a cache line
+template <typename T>
+struct CacheAligned {
+    typedef T value_type;
+    static const size_t ALIGNMENT = 64;
+
+    CacheAligned() = default;
+    template <typename U>
+    CacheAligned(const CacheAligned<U>&) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(ALIGNMENT))); }
+    void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(ALIGNMENT)); }
+    template <typename U>
+    bool operator==(const CacheAligned<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const CacheAligned<U>&) const { return false; }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, CacheAligned<T>>;
+
+// The cubies of a cube as one array per field, indexed by cube id (the id itself is the index):
+// slots as 32-bit ints, orientations as bytes. A pass over one field reads only that field, and a
+// layer turn touches a 4-byte and a 1-byte entry per cubie instead of a whole Cube.
+// It reads as a sequence of Cube values, so loops written for a std::vector<Cube> still work. The
+// values are built on the fly, so the iterator is an input iterator: no references, no operator->.
+class CubieArrays {
+public:
+    class iterator {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef Cube value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef void pointer;
+        typedef Cube reference;
+
+        iterator(const CubieArrays* cubies, int id) : cubies(cubies), id(id) {}
+        Cube operator*() const { return (*cubies)[id]; }
+        iterator& operator++() { id++; return *this; }
+        iterator operator++(int) { iterator old = *this; id++; return old; }
+        bool operator==(const iterator& other) const { return id == other.id; }
+        bool operator!=(const iterator& other) const { return id != other.id; }
+    private:
+        const CubieArrays* cubies;
+        int id;
+    };
+
+    // Every cubie home, in its own slot and unturned
+    void reset(int count);
+
+    size_t size() const { return slots.size(); }
+    bool empty() const { return slots.empty(); }
+    Cube operator[](size_t id) const { return Cube{int(id), slots[id], orientations[id]}; }
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, int(size())); }
+
+    int slot(int id) const { return slots[id]; }
+    uint8_t orientation(int id) const { return orientations[id]; }
+    void set(int id, int slot, uint8_t orientation) { slots[id] = slot; orientations[id] = orientation; }
+
+    // Settle a turn of a layer that SlotIndex has already turned: every cubie of the layer takes
+    // its new slot and turns quarterTurns * 90 degrees about the positive axis
+    void turnLayer(const SlotIndex::Layer& layer, int axis, int quarterTurns);
+
+    // out[id] = m * translate(centres[slot]) * rotation of the orientation, for every cubie or only
+    // the cubies of a layer. Four floats at a time with SSE: the rotation columns come from m times
+    // each of the 24 rotations, worked out once per call, and the translation is m applied to the
+    // slot's centre.
+    void transform(const glm::mat4& m, const glm::vec4* centres, glm::mat4* out) const;
+    void transform(const glm::mat4& m, const glm::vec4* centres, const SlotIndex::Layer& layer, glm::mat4* out) const;
+
+private:
+    AlignedVector<int32_t> slots;
+    AlignedVector<uint8_t> orientations;
+};
+
+#endif // CUBIEARRAYS_H
@@ -0,0 +1,130 @@
+#include "ImageFile.h"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+const size_t MAX_STORED_BLOCK = 65535;
+
+const std::array<uint32_t, 256>& crcTable() {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t;
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+    const std::array<uint32_t, 256>& table = crcTable();
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t adler32(const uint8_t* data, size_t size) {
+    uint32_t a = 1, b = 0;
+    while (size > 0) {
+        const size_t run = std::min<size_t>(size, 5552); // the most bytes before b can overflow
+        for (size_t i = 0; i < run; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += run;
+        size -= run;
+    }
+    return b << 16 | a;
+}
+
+void putBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(uint8_t(value >> shift));
+}
+
+// Length, type and data, then the CRC of type and data
+void putChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t size) {
+    putBigEndian(out, uint32_t(size));
+    const size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    putBigEndian(out, crc32(&out[start], size + 4));
+}
+
+bool writeFile(const std::string& path, const std::vector<uint8_t>& bytes, std::string& error) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "cannot write " + path;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    if (!out) {
+        error = "failed writing " + path;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool writePPM(const std::string& path, const uint8_t* rgba, int width, int height, std::string& error) {
+    const std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    std::vector<uint8_t> bytes(header.begin(), header.end());
+    bytes.resize(header.size() + size_t(width) * height * 3);
+    uint8_t* rgb = &bytes[header.size()];
+    for (size_t i = 0; i < size_t(width) * height; i++) {
+        rgb[3 * i] = rgba[4 * i];
+        rgb[3 * i + 1] = rgba[4 * i + 1];
+        rgb[3 * i + 2] = rgba[4 * i + 2];
+    }
+    return writeFile(path, bytes, error);
+}
+
+bool writePNG(const std::string& path, const uint8_t* rgba, int width, int height, std::string& error) {
+    // Every row gets filter type 0, none
+    const size_t rowBytes = size_t(width) * 4;
+    std::vector<uint8_t> scanlines(height * (rowBytes + 1));
+    for (int y = 0; y < height; y++) {
+        scanlines[y * (rowBytes + 1)] = 0;
+        std::copy(rgba + y * rowBytes, rgba + (y + 1) * rowBytes, &scanlines[y * (rowBytes + 1) + 1]);
+    }
+
+    // zlib stream of stored blocks: a 5 byte header each, then the data as is
+    std::vector<uint8_t> zlib = {0x78, 0x01};
+    zlib.reserve(2 + scanlines.size() + 5 * (scanlines.size() / MAX_STORED_BLOCK + 1) + 4);
+    for (size_t offset = 0;; offset += MAX_STORED_BLOCK) {
+        const size_t size = std::min(MAX_STORED_BLOCK, scanlines.size() - offset);
+        const bool last = offset + size == scanlines.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(uint8_t(size));
+        zlib.push_back(uint8_t(size >> 8));
+        zlib.push_back(uint8_t(~size));
+        zlib.push_back(uint8_t(~size >> 8));
+        zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + size);
+        if (last)
+            break;
+    }
+    putBigEndian(zlib, adler32(scanlines.data(), scanlines.size()));
+
+    std::vector<uint8_t> header;
+    putBigEndian(header, uint32_t(width));
+    putBigEndian(header, uint32_t(height));
+    header.insert(header.end(), {8, 6, 0, 0, 0}); // 8 bits per channel, RGBA, deflate, filter method 0, no interlace
+
+    static const uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<uint8_t> bytes(SIGNATURE, SIGNATURE + 8);
+    bytes.reserve(8 + 25 + zlib.size() + 12 + 12);
+    putChunk(bytes, "IHDR", header.data(), header.size());
+    putChunk(bytes, "IDAT", zlib.data(), zlib.size());
+    putChunk(bytes, "IEND", nullptr, 0);
+    return writeFile(path, bytes, error);
+}
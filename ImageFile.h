@@ -0,0 +1,15 @@
+#ifndef IMAGEFILE_H
+#define IMAGEFILE_H
+
+#include <cstdint>
+#include <string>
+
+// Writers for 8-bit RGBA pixels, rows top first, with no image library. PPM (binary P6) drops
+// the alpha channel; PNG keeps it, so the background of a render cleared to transparent stays
+// transparent. The PNG is stored without compression (deflate "stored" blocks): writing it costs
+// a CRC and an Adler checksum over the pixels, which keeps batch rendering from waiting on the
+// encoder, at the price of files about as big as the pixels.
+bool writePPM(const std::string& path, const uint8_t* rgba, int width, int height, std::string& error);
+bool writePNG(const std::string& path, const uint8_t* rgba, int width, int height, std::string& error);
+
+#endif // IMAGEFILE_H
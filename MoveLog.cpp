@@ -0,0 +1,70 @@
+#include "MoveLog.h"
+
+void MoveLog::Replay::apply(Turn turn) {
+    const int axis = turnAxis(turn), layer = turnLayer(turn);
+    int& pending = pendingEighths[axis * slots.size() + layer];
+    pending += turnEighths(turn);
+    if (pending % 2 == 0) {
+        slots.turn(axis, layer, pending / 2);
+        pending = 0;
+    }
+}
+
+MoveLog::MoveLog(size_t capacity) : ring(capacity > 0 ? capacity : 1) {
+    clear();
+}
+
+void MoveLog::clear(const SlotIndex& slots) {
+    head = 0;
+    applied = 0;
+    undone = 0;
+    dropped = 0;
+    base.slots = slots;
+    base.pendingEighths.assign(3 * slots.size(), 0);
+}
+
+void MoveLog::record(int axis, int layer, int eighths) {
+    undone = 0;
+    if (applied == ring.size()) {
+        base.apply(ring[head]);
+        head = (head + 1) % ring.size();
+        applied--;
+        dropped++;
+    }
+    ring[(head + applied) % ring.size()] = encode(axis, layer, eighths);
+    applied++;
+}
+
+bool MoveLog::undo(Turn& turn) {
+    if (applied == 0)
+        return false;
+    applied--;
+    undone++;
+    turn = at(applied);
+    return true;
+}
+
+bool MoveLog::redo(Turn& turn) {
+    if (undone == 0)
+        return false;
+    turn = at(applied);
+    applied++;
+    undone--;
+    return true;
+}
+
+std::vector<MoveLog::Turn> MoveLog::cubieTurns(int id) const {
+    std::vector<Turn> turns;
+    Replay replay = base;
+    for (size_t i = 0; i < applied; i++) {
+        const Turn turn = at(i);
+        for (int cubie : replay.slots.layerCubies(turnAxis(turn), turnLayer(turn))) {
+            if (cubie == id) {
+                turns.push_back(turn);
+                break;
+            }
+        }
+        replay.apply(turn);
+    }
+    return turns;
+}
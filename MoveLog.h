@@ -0,0 +1,59 @@
+#ifndef MOVELOG_H
+#define MOVELOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SlotIndex.h"
+
+// Bounded history of the layer turns made on a cube, two bytes per turn: the layer and its axis
+// in the high bits and the turn in eighths (45 degree steps) about the positive axis, -3 to 4, in
+// the low three bits. Turns live in a fixed ring buffer, so memory stays the same however long a
+// session runs; once it is full each new turn drops the oldest one, which is folded into a
+// snapshot of the slots so the history of any cubie can still be rebuilt from what is kept.
+// Undone turns stay in the buffer for redo until a new turn is recorded.
+class MoveLog {
+public:
+    typedef uint16_t Turn;
+    static const size_t DEFAULT_CAPACITY = 1 << 15; // 64 KiB of turns
+    static const int MAX_LAYERS = 1 << 11;
+
+    static Turn encode(int axis, int layer, int eighths) { return static_cast<Turn>(layer << 5 | axis << 3 | (eighths & 7)); }
+    static int turnAxis(Turn turn) { return turn >> 3 & 3; }
+    static int turnLayer(Turn turn) { return turn >> 5; }
+    static int turnEighths(Turn turn) { return (turn & 7) > 4 ? (turn & 7) - 8 : turn & 7; }
+
+    explicit MoveLog(size_t capacity = DEFAULT_CAPACITY);
+
+    // Forget every turn; base is the slot layout the next recorded turn starts from
+    void clear(const SlotIndex& base = SlotIndex());
+    void record(int axis, int layer, int eighths);
+    // The turn to revert (undo) or to make again (redo); false when there is none
+    bool undo(Turn& turn);
+    bool redo(Turn& turn);
+
+    size_t size() const { return applied; }                      // turns that can be undone
+    size_t redoSize() const { return undone; }
+    Turn at(size_t i) const { return ring[(head + i) % ring.size()]; } // oldest first
+    long long droppedCount() const { return dropped; }           // turns lost to the capacity
+
+    // The kept turns, oldest first, that moved the cubie
+    std::vector<Turn> cubieTurns(int id) const;
+
+private:
+    // Slot layout plus the unsettled eighths of every layer, as RubiksCube tracks them
+    struct Replay {
+        SlotIndex slots;
+        std::vector<int> pendingEighths; // axis * size + layer
+        void apply(Turn turn);
+    };
+
+    std::vector<Turn> ring;
+    size_t head = 0;    // oldest kept turn
+    size_t applied = 0; // turns from head that are in effect
+    size_t undone = 0;  // undone turns after those, kept for redo
+    long long dropped = 0;
+    Replay base;        // the cube before the oldest kept turn
+};
+
+#endif // MOVELOG_H
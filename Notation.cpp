@@ -0,0 +1,199 @@
+#include "Notation.h"
+
+namespace {
+
+constexpr char FACE_NAMES[NUM_FACES + 1] = "RLUDBF";
+
+// Whole-cube rotation of the notation faces by a clockwise quarter turn about x, y or z: after the
+// rotation the face named CYCLES[axis][i] is the one that was named CYCLES[axis][i + 1]
+constexpr int CYCLES[3][4] = {
+    {2, 5, 3, 4}, // x: U takes F, F takes D, D takes B, B takes U
+    {5, 0, 4, 1}, // y: F takes R, R takes B, B takes L, L takes F
+    {0, 2, 1, 3}, // z: R takes U, U takes L, L takes D, D takes R
+};
+
+// Token kinds, in the order of their character classes
+enum Kind { FACE, WIDE, SLICE, ROTATION };
+
+// Character classes
+constexpr int SPACE = 0;
+constexpr int letterClass(int kind, int index) { return 1 + kind * 6 + index; }
+constexpr int MODIFIER_W = 25, MODIFIER_TWO = 26, MODIFIER_PRIME = 27, INVALID = 28;
+
+// Token states: 0 when no token is pending, otherwise the token's kind, index, clockwise quarter
+// turns (1 to 3) and modifier stage (0 after the letter, 1 after 2, 2 after ')
+constexpr int tokenState(int kind, int index, int quarters, int stage) {
+    return 1 + (kind * 6 + index) * 9 + (quarters - 1) * 3 + stage;
+}
+constexpr int stateKind(int state) { return (state - 1) / 54; }
+constexpr int stateIndex(int state) { return (state - 1) / 9 % 6; }
+constexpr int stateQuarters(int state) { return (state - 1) % 9 / 3 + 1; }
+constexpr int stateStage(int state) { return (state - 1) % 3; }
+
+} // namespace
+
+constexpr MoveParser::Tables MoveParser::buildTables() {
+    Tables tables{};
+    for (int c = 0; c < 256; c++)
+        tables.classes[c] = INVALID;
+    for (int face = 0; face < NUM_FACES; face++) {
+        tables.classes[static_cast<unsigned char>(FACE_NAMES[face])] = letterClass(FACE, face);
+        tables.classes[static_cast<unsigned char>(FACE_NAMES[face] - 'A' + 'a')] = letterClass(WIDE, face);
+    }
+    tables.classes['M'] = letterClass(SLICE, 0);
+    tables.classes['E'] = letterClass(SLICE, 1);
+    tables.classes['S'] = letterClass(SLICE, 2);
+    tables.classes['x'] = letterClass(ROTATION, 0);
+    tables.classes['y'] = letterClass(ROTATION, 1);
+    tables.classes['z'] = letterClass(ROTATION, 2);
+    tables.classes['w'] = MODIFIER_W;
+    tables.classes['2'] = MODIFIER_TWO;
+    tables.classes['\''] = MODIFIER_PRIME;
+    for (char space : {' ', '\t', '\n', '\r', '\v', '\f'})
+        tables.classes[static_cast<unsigned char>(space)] = SPACE;
+
+    for (int characterClass = 0; characterClass < CLASSES; characterClass++)
+        tables.endMask[characterClass] = characterClass < MODIFIER_W ? 0xFF : 0;
+    for (int state = 0; state < STATES; state++) {
+        const bool pending = state != 0;
+        const int kind = stateKind(state), index = stateIndex(state);
+        const int quarters = stateQuarters(state), stage = stateStage(state);
+        for (int characterClass = 0; characterClass < CLASSES; characterClass++) {
+            uint8_t next = ERROR;
+            if (characterClass == SPACE)
+                next = 0;
+            else if (characterClass < MODIFIER_W)
+                next = uint8_t(tokenState((characterClass - 1) / 6, (characterClass - 1) % 6, 1, 0));
+            else if (characterClass == MODIFIER_W && pending && kind == FACE && stage == 0)
+                next = uint8_t(tokenState(WIDE, index, quarters, 0));
+            else if (characterClass == MODIFIER_TWO && pending && stage == 0)
+                next = uint8_t(tokenState(kind, index, 2, 1));
+            else if (characterClass == MODIFIER_PRIME && pending && stage < 2)
+                next = uint8_t(tokenState(kind, index, 4 - quarters, 2));
+            tables.next[state][characterClass] = next;
+        }
+    }
+
+    // Every orientation reachable from the identity by quarter rotations, in discovery order
+    int count = 1;
+    for (int face = 0; face < NUM_FACES; face++)
+        tables.faces[0][face] = int8_t(face);
+    for (int orientation = 0; orientation < count; orientation++) {
+        for (int axis = 0; axis < 3; axis++) {
+            int8_t faces[NUM_FACES] = {};
+            for (int face = 0; face < NUM_FACES; face++)
+                faces[face] = tables.faces[orientation][face];
+            for (int i = 0; i < 4; i++)
+                faces[CYCLES[axis][i]] = tables.faces[orientation][CYCLES[axis][(i + 1) % 4]];
+            int found = 0;
+            while (found < count) {
+                bool same = true;
+                for (int face = 0; face < NUM_FACES; face++)
+                    same = same && tables.faces[found][face] == faces[face];
+                if (same)
+                    break;
+                found++;
+            }
+            if (found == count) {
+                for (int face = 0; face < NUM_FACES; face++)
+                    tables.faces[count][face] = faces[face];
+                count++;
+            }
+            tables.rotated[orientation][axis][1] = uint8_t(found);
+        }
+    }
+    for (int orientation = 0; orientation < 24; orientation++) {
+        for (int axis = 0; axis < 3; axis++) {
+            tables.rotated[orientation][axis][0] = uint8_t(orientation);
+            for (int quarters = 2; quarters < 4; quarters++)
+                tables.rotated[orientation][axis][quarters] = tables.rotated[tables.rotated[orientation][axis][quarters - 1]][axis][1];
+        }
+        for (int face = 0; face < NUM_FACES; face++) {
+            const int modelFace = tables.faces[orientation][face];
+            tables.moves[orientation][face][0] = -1;
+            for (int quarters = 1; quarters < 4; quarters++)
+                tables.moves[orientation][face][quarters] = int8_t(makeMove(modelFace, clockwiseTurns(modelFace) * quarters));
+        }
+    }
+
+    // What each token stands for in each orientation: r = L x, M = R L' x', E = U D' y', S = B F' z
+    for (int orientation = 0; orientation < 24; orientation++) {
+        tables.ends[orientation][0] = {{0, 0}, 0, uint8_t(orientation)};
+        for (int state = 1; state < STATES; state++) {
+            const int index = stateIndex(state), quarters = stateQuarters(state);
+            if (stateKind(state) >= SLICE && index >= 3)
+                continue; // there are only three slices and rotations; these states are never reached
+            const auto move = [&](int face, int clockwiseQuarters) { return tables.moves[orientation][face][clockwiseQuarters & 3]; };
+            const auto rotate = [&](int axis, int clockwiseQuarters) { return tables.rotated[orientation][axis][clockwiseQuarters & 3]; };
+            TokenEnd& end = tables.ends[orientation][state];
+            switch (stateKind(state)) {
+            case FACE:
+                end = {{move(index, quarters), 0}, 1, uint8_t(orientation)};
+                break;
+            case WIDE:
+                end = {{move(index ^ 1, quarters), 0}, 1, rotate(index / 2, index == 0 || index == 2 || index == 5 ? quarters : -quarters)};
+                break;
+            case SLICE:
+                end = {{move(2 * index, quarters), move(2 * index + 1, -quarters)}, 2, rotate(index, index == 2 ? quarters : -quarters)};
+                break;
+            default:
+                end = {{0, 0}, 0, rotate(index, quarters)};
+                break;
+            }
+        }
+    }
+    return tables;
+}
+
+const MoveParser::Tables MoveParser::TABLES = MoveParser::buildTables();
+
+void MoveParser::reset() {
+    state = 0;
+    orientation = 0;
+    offset = 0;
+    errorMessage = nullptr;
+    errorAt = 0;
+}
+
+bool MoveParser::fail(uint8_t characterClass, size_t at) {
+    errorMessage = characterClass == INVALID ? "unknown move" : "misplaced modifier";
+    errorAt = at;
+    return false;
+}
+
+bool parseMoves(std::string_view text, std::vector<int>& moves, std::string& error) {
+    MoveParser parser;
+    auto append = [&moves](int move) { moves.push_back(move); };
+    if (parser.feed(text, append) && parser.finish(append))
+        return true;
+    const size_t at = parser.errorOffset();
+    error = std::string(parser.error()) + " '" + std::string(1, text[at]) + "' at column " + std::to_string(at + 1);
+    return false;
+}
+
+char* writeMove(int move, char* out) {
+    const int face = moveFace(move), quarterTurns = moveQuarterTurns(move);
+    *out++ = FACE_NAMES[face];
+    if (quarterTurns == 2)
+        *out++ = '2';
+    else if (quarterTurns != clockwiseTurns(face))
+        *out++ = '\'';
+    return out;
+}
+
+std::string formatMove(int move) {
+    char name[2];
+    return std::string(name, writeMove(move, name));
+}
+
+std::string formatMoves(const std::vector<int>& moves) {
+    std::string text(moves.size() * 3, ' ');
+    char* out = &text[0];
+    for (size_t i = 0; i < moves.size(); i++) {
+        if (i > 0)
+            out++; // keep the space
+        out = writeMove(moves[i], out);
+    }
+    text.resize(out - text.data());
+    return text;
+}
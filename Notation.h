@@ -0,0 +1,131 @@
+#ifndef NOTATION_H
+#define NOTATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "CubeState.h"
+
+// Standard (Singmaster) notation:
+//   R L U D B F    clockwise quarter turn of that face, seen from outside the cube
+//   r l u d b f    wide turns (face and middle layer), also written Rw, Lw, ...
+//   M E S          middle slice turns, following L, D and F respectively
+//   x y z          whole-cube rotations, following R, U and F
+// each optionally followed by 2 (half turn) and/or ' (counter-clockwise). Moves may be separated
+// by whitespace or written back to back ("RU'F2").
+//
+// The cube model only turns outer faces about fixed centres, so wide and slice turns are reduced
+// to outer turns plus a rotation of the frame: M is R L' x', r is L x. Rotations only change which
+// model face later letters refer to, so a sequence always becomes the equivalent outer turns.
+
+// Streaming parser: feed() takes the text in chunks of any size (a token may straddle two chunks)
+// and calls sink(move) with each CubeState move index, in order, before it returns; finish() ends
+// the last token. Nothing is allocated. After an error the moves before the bad character have
+// been passed to the sink and the parser stays failed until reset().
+//
+// Parsing is a table-driven state machine: the pending token (kind, face and modifiers) is one
+// state byte and the frame one of the 24 cube orientations, and a table gives, for every frame
+// and token, the outer turns the token ends with and the frame after it. Each character costs a
+// few table lookups and no data-dependent branches.
+class MoveParser {
+public:
+    MoveParser() { reset(); }
+    void reset();
+
+    template <typename Sink>
+    bool feed(std::string_view chunk, Sink&& sink);
+    template <typename Sink>
+    bool finish(Sink&& sink);
+
+    bool failed() const { return errorMessage != nullptr; }
+    const char* error() const { return errorMessage; }
+    size_t errorOffset() const { return errorAt; } // bytes from the start of the stream
+    // Model face that a notation face (numbered like model faces) currently refers to
+    int modelFace(int face) const { return TABLES.faces[orientation][face]; }
+
+private:
+    static const int CLASSES = 29; // space, 24 token letters (kind, index), w, 2, ', invalid
+    static const int STATES = 217; // no token, then kind x index x quarter turns x modifier stage
+    static const uint8_t ERROR = 0xFF;
+    static const int BUFFER = 256;
+
+    struct TokenEnd {
+        int8_t moves[2]; // outer turns the token stands for
+        uint8_t count;
+        uint8_t frame;   // orientation after the token
+    };
+    struct Tables {
+        uint8_t classes[256];              // class of every character
+        uint8_t next[STATES][CLASSES];     // state after a character, ERROR if it is not allowed
+        uint8_t endMask[CLASSES];          // 0xFF for characters that end the pending token
+        TokenEnd ends[24][STATES];         // per orientation and token state
+        int8_t faces[24][NUM_FACES];       // model face of each notation face, per orientation
+        int8_t moves[24][NUM_FACES][4];    // move of each notation face by clockwise quarters
+        uint8_t rotated[24][3][4];         // orientation after clockwise quarter rotations about x, y, z
+    };
+    static constexpr Tables buildTables();
+    static const Tables TABLES;
+
+    bool fail(uint8_t characterClass, size_t at);
+
+    uint8_t state;
+    uint8_t orientation;
+    size_t offset;
+    const char* errorMessage;
+    size_t errorAt;
+};
+
+// Quarter turns about the positive axis that turn a face clockwise seen from outside: negative
+// for right, up and front, which face along their positive axis
+constexpr int clockwiseTurns(int face) { return face == 0 || face == 2 || face == 5 ? 3 : 1; }
+
+// Whole-text convenience: appends the moves of text; false (with a message) on a bad token
+bool parseMoves(std::string_view text, std::vector<int>& moves, std::string& error);
+
+// Writes the name of move (at most 2 characters) to out and returns the end
+char* writeMove(int move, char* out);
+std::string formatMove(int move);
+std::string formatMoves(const std::vector<int>& moves); // space separated
+
+template <typename Sink>
+bool MoveParser::feed(std::string_view chunk, Sink&& sink) {
+    if (failed())
+        return false;
+    int buffer[BUFFER];
+    int count = 0;
+    uint8_t current = state, frame = orientation;
+    for (size_t i = 0; i < chunk.size(); i++) {
+        const uint8_t characterClass = TABLES.classes[static_cast<unsigned char>(chunk[i])];
+        const uint8_t ends = TABLES.endMask[characterClass];
+        const TokenEnd& end = TABLES.ends[frame][current];
+        buffer[count] = end.moves[0];
+        buffer[count + 1] = end.moves[1];
+        count += end.count & ends;
+        frame = (end.frame & ends) | (frame & ~ends);
+        current = TABLES.next[current][characterClass];
+        if (current == ERROR || count > BUFFER - 3) {
+            for (int j = 0; j < count; j++)
+                sink(buffer[j]);
+            count = 0;
+            if (current == ERROR) {
+                orientation = frame;
+                return fail(characterClass, offset + i);
+            }
+        }
+    }
+    for (int j = 0; j < count; j++)
+        sink(buffer[j]);
+    state = current;
+    orientation = frame;
+    offset += chunk.size();
+    return true;
+}
+
+template <typename Sink>
+bool MoveParser::finish(Sink&& sink) {
+    return feed(" ", sink); // a space ends the pending token
+}
+
+#endif // NOTATION_H
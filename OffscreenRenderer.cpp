@@ -0,0 +1,128 @@
+#include "OffscreenRenderer.h"
+#include <Debugger.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+
+OffscreenRenderer::OffscreenRenderer(CubeRenderer& renderer, int tileWidth, int tileHeight, int tilesPerBatch)
+    : renderer(renderer), width(std::max(1, tileWidth)), height(std::max(1, tileHeight)) {
+    GLint maxSize = 0;
+    GLCall(glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxSize));
+    width = std::min(width, int(maxSize));
+    height = std::min(height, int(maxSize));
+    tiles = std::max(1, std::min(tilesPerBatch, int(maxSize) / height));
+
+    GLCall(glGenFramebuffers(1, &framebuffer));
+    GLCall(glGenRenderbuffers(1, &colorRenderbuffer));
+    GLCall(glGenRenderbuffers(1, &depthRenderbuffer));
+    GLCall(glBindRenderbuffer(GL_RENDERBUFFER, colorRenderbuffer));
+    GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height * tiles));
+    GLCall(glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer));
+    GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height * tiles));
+    GLCall(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+    GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderbuffer));
+    GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer));
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+    for (Batch& batch : batches) {
+        GLCall(glGenBuffers(1, &batch.pixelBuffer));
+        GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, batch.pixelBuffer));
+        GLCall(glBufferData(GL_PIXEL_PACK_BUFFER, tileBytes() * tiles, nullptr, GL_STREAM_READ));
+    }
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+}
+
+OffscreenRenderer::~OffscreenRenderer() {
+    if (mapped)
+        release();
+    for (Batch& batch : batches) {
+        if (batch.fence)
+            glDeleteSync(batch.fence);
+        GLCall(glDeleteBuffers(1, &batch.pixelBuffer));
+    }
+    GLCall(glDeleteRenderbuffers(1, &colorRenderbuffer));
+    GLCall(glDeleteRenderbuffers(1, &depthRenderbuffer));
+    GLCall(glDeleteFramebuffers(1, &framebuffer));
+}
+
+bool OffscreenRenderer::begin() {
+    if (drawing >= 0 || inFlight == BUFFERS)
+        return false;
+    drawing = (oldest + inFlight) % BUFFERS;
+    batches[drawing].count = 0;
+
+    GLCall(glGetIntegerv(GL_VIEWPORT, savedViewport));
+    GLCall(glGetIntegerv(GL_FRONT_FACE, &savedFrontFace));
+    GLCall(glFrontFace(GL_CW)); // drawing upside down mirrors the winding
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+    GLCall(glViewport(0, 0, width, height * tiles));
+    GLCall(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
+    GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+    return true;
+}
+
+bool OffscreenRenderer::draw(const RubiksCube& cube, const glm::mat4& viewProjection) {
+    if (drawing < 0 || batches[drawing].count == tiles)
+        return false;
+    static const glm::mat4 upsideDown = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, -1.0f, 1.0f));
+    GLCall(glViewport(0, batches[drawing].count * height, width, height));
+    renderer.draw(cube, upsideDown * viewProjection);
+    batches[drawing].count++;
+    return true;
+}
+
+void OffscreenRenderer::end() {
+    if (drawing < 0)
+        return;
+    Batch& batch = batches[drawing];
+    GLCall(glReadBuffer(GL_COLOR_ATTACHMENT0));
+    GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, batch.pixelBuffer));
+    if (batch.count > 0)
+        GLCall(glReadPixels(0, 0, width, height * batch.count, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    GLCall(glFlush());
+
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GLCall(glViewport(savedViewport[0], savedViewport[1], savedViewport[2], savedViewport[3]));
+    GLCall(glFrontFace(savedFrontFace));
+    drawing = -1;
+    inFlight++;
+}
+
+const uint8_t* OffscreenRenderer::collect(int& count) {
+    count = 0;
+    if (inFlight == 0 || mapped)
+        return nullptr;
+    Batch& batch = batches[oldest];
+    if (batch.fence) {
+        while (glClientWaitSync(batch.fence, 0, GLuint64(1000000000)) == GL_TIMEOUT_EXPIRED) {
+        }
+        glDeleteSync(batch.fence);
+        batch.fence = nullptr;
+    }
+    mapped = true;
+    if (batch.count == 0)
+        return nullptr;
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, batch.pixelBuffer));
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, tileBytes() * batch.count, GL_MAP_READ_BIT);
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    if (pixels)
+        count = batch.count;
+    return static_cast<const uint8_t*>(pixels);
+}
+
+void OffscreenRenderer::release() {
+    if (!mapped)
+        return;
+    Batch& batch = batches[oldest];
+    if (batch.count > 0) {
+        GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, batch.pixelBuffer));
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER); // false after a failed map, nothing to undo
+        GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    }
+    mapped = false;
+    oldest = (oldest + 1) % BUFFERS;
+    inFlight--;
+}
@@ -0,0 +1,63 @@
+#ifndef OFFSCREEN_RENDERER_H
+#define OFFSCREEN_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "CubeRenderer.h"
+#include "RubiksCube.h"
+
+// Renders cubes into images with no window, for thumbnails and batch frame output. It needs a
+// current context, such as the EGL surfaceless one of Thumbnails, and draws with the renderer's
+// shader, so images look like the window.
+//
+// A batch is many small images at once: the framebuffer is a column of tiles, one cube each, so a
+// batch is one clear, one draw call per cube and one read back into a pixel buffer object behind
+// a fence. Tiles are drawn upside down, which makes the read back rows come out top first and each
+// tile's pixels one contiguous block, handed out as mapped, with no copy. There are two pixel
+// buffers, so the next batch is drawn while the last one is being written out.
+class OffscreenRenderer {
+public:
+    static const int BUFFERS = 2;
+
+    // tilesPerBatch is lowered to what fits the largest renderbuffer
+    OffscreenRenderer(CubeRenderer& renderer, int tileWidth, int tileHeight, int tilesPerBatch);
+    ~OffscreenRenderer();
+    OffscreenRenderer(const OffscreenRenderer&) = delete;
+    OffscreenRenderer& operator=(const OffscreenRenderer&) = delete;
+
+    int capacity() const { return tiles; }
+    int tileWidth() const { return width; }
+    int tileHeight() const { return height; }
+    size_t tileBytes() const { return size_t(width) * height * 4; } // RGBA
+
+    // Start a batch; false when every pixel buffer holds a batch not yet collected
+    bool begin();
+    // Draw cube into the batch's next tile; false when the batch is full
+    bool draw(const RubiksCube& cube, const glm::mat4& viewProjection);
+    // Start reading the batch back
+    void end();
+    // Wait for the oldest ended batch and map it: tile i at i * tileBytes(), RGBA rows top first,
+    // transparent where there is no cube. Null when no batch is in flight. Valid until release.
+    const uint8_t* collect(int& count);
+    void release();
+
+private:
+    struct Batch {
+        GLuint pixelBuffer = 0;
+        GLsync fence = nullptr;
+        int count = 0;
+    };
+
+    CubeRenderer& renderer;
+    int width, height, tiles;
+    GLuint framebuffer = 0, colorRenderbuffer = 0, depthRenderbuffer = 0;
+    Batch batches[BUFFERS];
+    int drawing = -1;   // batch between begin and end
+    int oldest = 0;     // next batch to collect
+    int inFlight = 0;   // ended and not released
+    bool mapped = false;
+    GLint savedViewport[4] = {};
+    GLint savedFrontFace = GL_CCW;
+};
+
+#endif // OFFSCREEN_RENDERER_H
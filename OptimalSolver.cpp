@@ -0,0 +1,217 @@
+#include "OptimalSolver.h"
+#include "RubiksCube.h"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <mutex>
+
+namespace {
+
+const int SPLIT_DEPTH = 3; // plies expanded by the caller before subtrees go to the pool
+const int MAX_DEPTH = 32;
+
+// State shared by every subtree search of one IDA* iteration
+struct Iteration {
+    const OptimalSolver& solver;
+    const CubeState& root;
+    int bound;
+    std::atomic<int> bestLength{INT_MAX};
+    std::mutex resultMutex;
+    std::vector<int> result;
+
+    Iteration(const OptimalSolver& solver, const CubeState& root, int bound)
+        : solver(solver), root(root), bound(bound) {}
+};
+
+struct SubtreeSearch {
+    Iteration& iteration;
+    int path[MAX_DEPTH];
+    long long nodes = 0;
+
+    explicit SubtreeSearch(Iteration& iteration) : iteration(iteration) {}
+
+    bool found() const { return iteration.bestLength.load(std::memory_order_relaxed) <= iteration.bound; }
+
+    void record(int length) {
+        // The coordinates only cover twist, flip, slice and corners: replay to check the edges
+        CubeState state = iteration.root;
+        for (int i = 0; i < length; i++)
+            state.applyMove(path[i]);
+        if (!state.isSolved())
+            return;
+        std::lock_guard<std::mutex> lock(iteration.resultMutex);
+        if (iteration.bestLength.load() > length) {
+            iteration.result.assign(path, path + length);
+            iteration.bestLength.store(length);
+        }
+    }
+
+    // Returns true once this iteration has a solution, whoever found it
+    bool dfs(const OptimalSolver::Node& node, int depth) {
+        if (found())
+            return true;
+        nodes++;
+        if (depth == iteration.bound) {
+            if (node.twist == 0 && node.flip == 0 && node.slice == SOLVED_SLICE && node.cornerPerm == 0)
+                record(depth);
+            return found();
+        }
+        int lastFace = depth > 0 ? moveFace(path[depth - 1]) : -1;
+        int childMoves[NUM_MOVES];
+        OptimalSolver::Node children[NUM_MOVES];
+        int count = 0;
+        for (int move = 0; move < NUM_MOVES; move++) {
+            if (isRedundantAfter(lastFace, moveFace(move)))
+                continue;
+            childMoves[count] = move;
+            children[count++] = iteration.solver.move(node, move);
+        }
+        uint8_t distances[NUM_MOVES];
+        iteration.solver.heuristics(children, count, distances);
+        for (int i = 0; i < count; i++) {
+            if (depth + 1 + distances[i] > iteration.bound)
+                continue;
+            path[depth] = childMoves[i];
+            if (dfs(children[i], depth + 1))
+                return true;
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+OptimalSolver::OptimalSolver(const SolverTables& tables, int threads)
+    : tables(tables), pool(threads) {
+    cornerPermMoves.resize(size_t(CORNER_PERM_COUNT) * NUM_MOVES);
+    for (int perm = 0; perm < CORNER_PERM_COUNT; perm++) {
+        CubeState state = CubeState::solved();
+        setCornerPermCoord(state, perm);
+        for (int m = 0; m < NUM_MOVES; m++) {
+            CubeState moved = state;
+            moved.applyMove(m);
+            cornerPermMoves[perm * NUM_MOVES + m] = static_cast<uint16_t>(cornerPermCoord(moved));
+        }
+    }
+
+    // Breadth-first distances of every corner permutation
+    std::vector<uint8_t> distances(CORNER_PERM_COUNT, 0xFF);
+    std::vector<int> frontier = {0};
+    distances[0] = 0;
+    for (uint8_t depth = 1; !frontier.empty(); depth++) {
+        std::vector<int> next;
+        for (int perm : frontier) {
+            for (int m = 0; m < NUM_MOVES; m++) {
+                int moved = cornerPermMoves[perm * NUM_MOVES + m];
+                if (distances[moved] == 0xFF) {
+                    distances[moved] = depth;
+                    next.push_back(moved);
+                }
+            }
+        }
+        frontier.swap(next);
+    }
+    PruneTable::pack(distances, cornerPermDistances); // at most 11 moves
+    cornerPermPrune = PruneTable(cornerPermDistances.data());
+}
+
+bool OptimalSolver::useCornerDatabase(const std::string& path, std::string& error) {
+    return cornerDatabase.open(path, CornerSpace::NAME, CornerSpace::SIZE, error);
+}
+
+int OptimalSolver::heuristic(const Node& node) const {
+    int distance = std::max(tables.phase1Distance(node.twist, node.flip, node.slice), cornerPermPrune[node.cornerPerm]);
+    if (cornerDatabase.isOpen())
+        distance = std::max(distance, cornerDatabase.table()[uint32_t(node.cornerPerm) * TWIST_COUNT + node.twist]);
+    return distance;
+}
+
+void OptimalSolver::heuristics(const Node* nodes, int count, uint8_t* distances) const {
+    int twists[NUM_MOVES] = {}, flips[NUM_MOVES] = {}, slices[NUM_MOVES] = {};
+    uint32_t cornerPerms[NUM_MOVES] = {};
+    for (int i = 0; i < count; i++) {
+        twists[i] = nodes[i].twist;
+        flips[i] = nodes[i].flip;
+        slices[i] = nodes[i].slice;
+        cornerPerms[i] = nodes[i].cornerPerm;
+    }
+    uint8_t cornerDistances[NUM_MOVES];
+    tables.phase1Distances(twists, flips, slices, count, distances);
+    cornerPermPrune.lookup(cornerPerms, count, cornerDistances);
+    for (int i = 0; i < count; i++)
+        distances[i] = std::max(distances[i], cornerDistances[i]);
+    if (cornerDatabase.isOpen()) {
+        for (int i = 0; i < count; i++)
+            cornerPerms[i] = cornerPerms[i] * TWIST_COUNT + twists[i];
+        cornerDatabase.table().lookup(cornerPerms, count, cornerDistances);
+        for (int i = 0; i < count; i++)
+            distances[i] = std::max(distances[i], cornerDistances[i]);
+    }
+}
+
+OptimalSolver::Node OptimalSolver::move(const Node& node, int move) const {
+    return {tables.twistMove(node.twist, move), tables.flipMove(node.flip, move),
+            tables.sliceMove(node.slice, move), cornerPermMoves[node.cornerPerm * NUM_MOVES + move]};
+}
+
+bool OptimalSolver::solve(const CubeState& state, std::vector<int>& moves, int maxLength) {
+    moves.clear();
+    nodes = 0;
+    if (!state.isValid())
+        return false;
+    if (state.isSolved())
+        return true;
+    maxLength = std::min(maxLength, MAX_DEPTH - 1);
+
+    const Node root = {twistCoord(state), flipCoord(state), sliceCoord(state), cornerPermCoord(state)};
+    for (int bound = heuristic(root); bound <= maxLength; bound++) {
+        Iteration iteration(*this, state, bound);
+        if (bound <= SPLIT_DEPTH) {
+            SubtreeSearch search(iteration);
+            search.dfs(root, 0);
+            nodes += search.nodes;
+        } else {
+            // Expand the first plies here and hand every surviving subtree to the pool
+            std::array<int, SPLIT_DEPTH> prefix{};
+            auto expand = [&](auto& self, const Node& node, int depth) -> void {
+                if (depth == SPLIT_DEPTH) {
+                    pool.submit([this, &iteration, node, prefix] {
+                        SubtreeSearch search(iteration);
+                        std::copy(prefix.begin(), prefix.end(), search.path);
+                        search.dfs(node, SPLIT_DEPTH);
+                        nodes += search.nodes;
+                    });
+                    return;
+                }
+                int lastFace = depth > 0 ? moveFace(prefix[depth - 1]) : -1;
+                for (int move = 0; move < NUM_MOVES; move++) {
+                    if (isRedundantAfter(lastFace, moveFace(move)))
+                        continue;
+                    Node next = this->move(node, move);
+                    if (depth + 1 + heuristic(next) > bound)
+                        continue;
+                    prefix[depth] = move;
+                    self(self, next, depth + 1);
+                }
+            };
+            expand(expand, root, 0);
+            pool.wait();
+        }
+        if (iteration.bestLength.load() <= bound) {
+            moves = iteration.result;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool OptimalSolver::solve(const RubiksCube& cube, std::vector<FaceRotation>& solution, int maxLength) {
+    solution.clear();
+    CubeState state;
+    std::vector<int> moves;
+    if (!cube.getState(state) || !solve(state, moves, maxLength))
+        return false;
+    for (int move : moves)
+        solution.push_back(Solver::toFaceRotation(move));
+    return true;
+}
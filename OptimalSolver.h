@@ -0,0 +1,55 @@
+#ifndef OPTIMALSOLVER_H
+#define OPTIMALSOLVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CubeState.h"
+#include "PatternDatabase.h"
+#include "PruneTable.h"
+#include "Solver.h"
+#include "SolverTables.h"
+#include "WorkStealingPool.h"
+
+// Shortest (face-turn metric) solutions by IDA*. Each iteration expands the first few plies,
+// hands the remaining subtrees to a work-stealing pool and shares the best solution length
+// through an atomic, so as soon as one thread finds a solution of the current depth every other
+// subtree is abandoned. The heuristic is the maximum of the slice/twist and slice/flip pruning
+// tables and an exact corner-permutation distance table, and of the corner pattern database
+// (permutation and twist) when one is loaded.
+// One solve runs at a time per OptimalSolver; it uses every thread of the pool.
+class OptimalSolver {
+public:
+    static const int DEFAULT_MAX_LENGTH = 20;
+
+    explicit OptimalSolver(const SolverTables& tables, int threads = 0);
+    // Map the corner pattern database that TableTool pdb corners wrote to path; without it the
+    // search runs as before
+    bool useCornerDatabase(const std::string& path, std::string& error);
+
+    bool solve(const CubeState& state, std::vector<int>& moves, int maxLength = DEFAULT_MAX_LENGTH);
+    bool solve(const RubiksCube& cube, std::vector<FaceRotation>& solution, int maxLength = DEFAULT_MAX_LENGTH);
+
+    int threadCount() const { return pool.threadCount(); }
+    long long lastNodeCount() const { return nodes.load(); } // nodes expanded by the last solve
+
+    // Used by the search tasks
+    struct Node {
+        int twist, flip, slice, cornerPerm;
+    };
+    int heuristic(const Node& node) const;
+    void heuristics(const Node* nodes, int count, uint8_t* distances) const; // count <= NUM_MOVES
+    Node move(const Node& node, int move) const;
+
+private:
+    const SolverTables& tables;
+    std::vector<uint16_t> cornerPermMoves; // all 18 moves, cornerPerm * NUM_MOVES + move
+    std::vector<uint8_t> cornerPermDistances; // packed, viewed through cornerPermPrune
+    PruneTable cornerPermPrune;
+    PatternDatabase cornerDatabase; // indexed cornerPerm * TWIST_COUNT + twist, like CornerSpace
+    WorkStealingPool pool;
+    std::atomic<long long> nodes{0};
+};
+
+#endif // OPTIMALSOLVER_H
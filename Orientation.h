@@ -0,0 +1,95 @@
+#ifndef ORIENTATION_H
+#define ORIENTATION_H
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// The 24 rotations of a cube as exact integer matrices, numbered 0 (identity) to 23 in the order a
+// breadth-first walk over quarter turns about x, y and z finds them. A cubie's orientation is one
+// byte, composed through a product table, so no turn sequence can make it drift.
+struct OrientationTables {
+    int8_t matrices[24][3][3] = {}; // row-major, applied to column vectors
+    uint8_t products[24][24] = {};  // products[a][b]: b, then a
+    uint8_t quarterTurns[3][4] = {}; // 0 to 3 quarter turns about the positive x, y or z axis
+};
+
+constexpr OrientationTables buildOrientationTables() {
+    OrientationTables t;
+    for (int i = 0; i < 3; i++)
+        t.matrices[0][i][i] = 1;
+    int8_t generators[3][3][3] = {};
+    for (int axis = 0; axis < 3; axis++) {
+        // 90 degrees about the positive axis, right-handed like glm::rotate: (p[a], p[b]) -> (-p[b], p[a])
+        int a = (axis + 1) % 3, b = (axis + 2) % 3;
+        generators[axis][axis][axis] = 1;
+        generators[axis][a][b] = -1;
+        generators[axis][b][a] = 1;
+    }
+
+    auto multiply = [](const int8_t (&x)[3][3], const int8_t (&y)[3][3], int8_t (&out)[3][3]) {
+        for (int row = 0; row < 3; row++)
+            for (int col = 0; col < 3; col++) {
+                int sum = 0;
+                for (int k = 0; k < 3; k++)
+                    sum += x[row][k] * y[k][col];
+                out[row][col] = int8_t(sum);
+            }
+    };
+    auto find = [&t](const int8_t (&m)[3][3], int count) {
+        for (int o = 0; o < count; o++) {
+            bool same = true;
+            for (int row = 0; row < 3; row++)
+                for (int col = 0; col < 3; col++)
+                    same = same && t.matrices[o][row][col] == m[row][col];
+            if (same)
+                return o;
+        }
+        return count;
+    };
+
+    int count = 1;
+    for (int o = 0; o < count; o++) {
+        for (int axis = 0; axis < 3; axis++) {
+            int8_t next[3][3] = {};
+            multiply(generators[axis], t.matrices[o], next);
+            if (find(next, count) == count) {
+                for (int row = 0; row < 3; row++)
+                    for (int col = 0; col < 3; col++)
+                        t.matrices[count][row][col] = next[row][col];
+                count++;
+            }
+        }
+    }
+    for (int a = 0; a < 24; a++)
+        for (int b = 0; b < 24; b++) {
+            int8_t product[3][3] = {};
+            multiply(t.matrices[a], t.matrices[b], product);
+            t.products[a][b] = uint8_t(find(product, 24));
+        }
+    for (int axis = 0; axis < 3; axis++) {
+        t.quarterTurns[axis][0] = 0;
+        for (int q = 1; q < 4; q++) {
+            int8_t turn[3][3] = {};
+            multiply(generators[axis], t.matrices[t.quarterTurns[axis][q - 1]], turn);
+            t.quarterTurns[axis][q] = uint8_t(find(turn, 24));
+        }
+    }
+    return t;
+}
+
+constexpr OrientationTables ORIENTATION_TABLES = buildOrientationTables();
+
+// The orientation after turning one by quarters * 90 degrees about the positive axis
+inline uint8_t turnOrientation(uint8_t orientation, int axis, int quarters) {
+    return ORIENTATION_TABLES.products[ORIENTATION_TABLES.quarterTurns[axis][quarters & 3]][orientation];
+}
+
+inline glm::mat4 orientationMatrix(uint8_t orientation) {
+    glm::mat4 matrix(1.0f);
+    for (int row = 0; row < 3; row++)
+        for (int col = 0; col < 3; col++)
+            matrix[col][row] = float(ORIENTATION_TABLES.matrices[orientation][row][col]);
+    return matrix;
+}
+
+#endif // ORIENTATION_H
@@ -0,0 +1,221 @@
+#include "PatternDatabase.h"
+#include "CubeCoordinates.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace {
+
+const int UNREACHED = 0xF;
+const uint64_t CHUNK = 1 << 16; // states per task grab, a multiple of the 8 nibbles in a word
+
+// Placement of the tracked edges, slot of edge 0 first, as a mixed radix number: each digit is
+// the slot's position among the slots not taken by an earlier edge
+uint32_t placementRank(const int (&slots)[EdgeSpace::TRACKED]) {
+    uint32_t rank = 0;
+    for (int k = 0; k < EdgeSpace::TRACKED; k++) {
+        int digit = slots[k];
+        for (int j = 0; j < k; j++)
+            digit -= slots[j] < slots[k];
+        rank = rank * (NUM_EDGES - k) + digit;
+    }
+    return rank;
+}
+
+void placementSlots(uint32_t rank, int (&slots)[EdgeSpace::TRACKED]) {
+    int digits[EdgeSpace::TRACKED];
+    for (int k = EdgeSpace::TRACKED - 1; k >= 0; k--) {
+        digits[k] = int(rank % (NUM_EDGES - k));
+        rank /= NUM_EDGES - k;
+    }
+    bool taken[NUM_EDGES] = {};
+    for (int k = 0; k < EdgeSpace::TRACKED; k++) {
+        int slot = 0;
+        for (int free = digits[k]; taken[slot] || free > 0; slot++)
+            free -= !taken[slot];
+        slots[k] = slot;
+        taken[slot] = true;
+    }
+}
+
+} // namespace
+
+CornerSpace::CornerSpace() : permMoves(size_t(CORNER_PERM_COUNT) * NUM_MOVES), twistMoves(size_t(TWIST_COUNT) * NUM_MOVES) {
+    for (int perm = 0; perm < CORNER_PERM_COUNT; perm++) {
+        CubeState state = CubeState::solved();
+        setCornerPermCoord(state, perm);
+        for (int m = 0; m < NUM_MOVES; m++) {
+            CubeState moved = state;
+            moved.applyMove(m);
+            permMoves[perm * NUM_MOVES + m] = static_cast<uint16_t>(cornerPermCoord(moved));
+        }
+    }
+    for (int twist = 0; twist < TWIST_COUNT; twist++) {
+        CubeState state = CubeState::solved();
+        setTwistCoord(state, twist);
+        for (int m = 0; m < NUM_MOVES; m++) {
+            CubeState moved = state;
+            moved.applyMove(m);
+            twistMoves[twist * NUM_MOVES + m] = static_cast<uint16_t>(twistCoord(moved));
+        }
+    }
+}
+
+void CornerSpace::neighbours(uint64_t index, uint64_t (&next)[NUM_MOVES]) const {
+    const uint16_t* perm = &permMoves[index / TWIST_COUNT * NUM_MOVES];
+    const uint16_t* twist = &twistMoves[index % TWIST_COUNT * NUM_MOVES];
+    for (int m = 0; m < NUM_MOVES; m++)
+        next[m] = uint64_t(perm[m]) * TWIST_COUNT + twist[m];
+}
+
+uint64_t CornerSpace::index(const CubeState& state) const {
+    return uint64_t(cornerPermCoord(state)) * TWIST_COUNT + twistCoord(state);
+}
+
+// Place the tracked edges unflipped, the others anywhere, turn, and see where they went
+EdgeSpace::EdgeSpace() : placementMoves(PLACEMENTS * NUM_MOVES), flipMasks(PLACEMENTS * NUM_MOVES) {
+    for (uint32_t rank = 0; rank < PLACEMENTS; rank++) {
+        int slots[TRACKED];
+        placementSlots(rank, slots);
+        CubeState state = CubeState::solved();
+        bool taken[NUM_EDGES] = {};
+        for (int k = 0; k < TRACKED; k++) {
+            state.setEdge(slots[k], k, 0);
+            taken[slots[k]] = true;
+        }
+        for (int slot = 0, other = TRACKED; slot < NUM_EDGES; slot++)
+            if (!taken[slot])
+                state.setEdge(slot, other++, 0);
+        for (int m = 0; m < NUM_MOVES; m++) {
+            CubeState moved = state;
+            moved.applyMove(m);
+            int to[TRACKED];
+            uint8_t mask = 0;
+            for (int slot = 0; slot < NUM_EDGES; slot++) {
+                const int cubie = moved.edgeCubie(slot);
+                if (cubie < TRACKED) {
+                    to[cubie] = slot;
+                    mask |= uint8_t(moved.edgeFlip(slot) << cubie);
+                }
+            }
+            placementMoves[size_t(rank) * NUM_MOVES + m] = placementRank(to);
+            flipMasks[size_t(rank) * NUM_MOVES + m] = mask;
+        }
+    }
+}
+
+void EdgeSpace::neighbours(uint64_t index, uint64_t (&next)[NUM_MOVES]) const {
+    const size_t row = size_t(index >> TRACKED) * NUM_MOVES;
+    const uint64_t flips = index & ((1 << TRACKED) - 1);
+    for (int m = 0; m < NUM_MOVES; m++)
+        next[m] = uint64_t(placementMoves[row + m]) << TRACKED | (flips ^ flipMasks[row + m]);
+}
+
+uint64_t EdgeSpace::index(const CubeState& state) const {
+    int slots[TRACKED];
+    uint64_t flips = 0;
+    for (int slot = 0; slot < NUM_EDGES; slot++) {
+        const int cubie = state.edgeCubie(slot);
+        if (cubie < TRACKED) {
+            slots[cubie] = slot;
+            flips |= uint64_t(state.edgeFlip(slot)) << cubie;
+        }
+    }
+    return uint64_t(placementRank(slots)) << TRACKED | flips;
+}
+
+bool buildPatternDatabase(const PatternSpace& space, int threads, std::vector<uint8_t>& packed,
+                          const std::function<void(const PatternLevel&)>& onLevel) {
+    const uint64_t size = space.size();
+    const uint64_t wordCount = (size + 7) / 8;
+    std::unique_ptr<std::atomic<uint32_t>[]> words(new std::atomic<uint32_t>[wordCount]);
+    for (uint64_t w = 0; w < wordCount; w++)
+        words[w].store(0xFFFFFFFF, std::memory_order_relaxed);
+    auto distance = [&words](uint64_t i) {
+        return int(words[i >> 3].load(std::memory_order_relaxed) >> (4 * (i & 7)) & 0xF);
+    };
+    // Lower an unreached nibble to depth. Within a level every writer writes the same depth, so
+    // racing writers agree; true for the one that found the nibble unreached.
+    auto reach = [&words](uint64_t i, int depth) {
+        const int shift = 4 * int(i & 7);
+        const uint32_t before = words[i >> 3].fetch_and(~(uint32_t(UNREACHED ^ depth) << shift), std::memory_order_relaxed);
+        return (before >> shift & 0xF) == UNREACHED;
+    };
+
+    WorkStealingPool pool(threads);
+    reach(space.goal(), 0);
+    uint64_t reached = 1, frontier = 1;
+    for (int depth = 0; reached < size; depth++) {
+        if (depth + 1 >= UNREACHED || frontier == 0)
+            return false;
+        const bool backward = size - reached < frontier;
+        auto start = std::chrono::steady_clock::now();
+        std::atomic<uint64_t> nextChunk{0}, found{0};
+        auto search = [&] {
+            uint64_t local = 0;
+            uint64_t next[NUM_MOVES];
+            for (uint64_t begin; (begin = nextChunk.fetch_add(CHUNK)) < size;) {
+                const uint64_t end = std::min(size, begin + CHUNK);
+                for (uint64_t i = begin; i < end; i++) {
+                    if (words[i >> 3].load(std::memory_order_relaxed) == 0xFFFFFFFF && !backward) {
+                        i |= 7; // nothing on the frontier in this word
+                        continue;
+                    }
+                    const int d = distance(i);
+                    if (backward && d == UNREACHED) {
+                        space.neighbours(i, next);
+                        for (int m = 0; m < NUM_MOVES; m++) {
+                            if (distance(next[m]) == depth) {
+                                local += reach(i, depth + 1);
+                                break;
+                            }
+                        }
+                    } else if (!backward && d == depth) {
+                        space.neighbours(i, next);
+                        for (int m = 0; m < NUM_MOVES; m++)
+                            if (distance(next[m]) == UNREACHED)
+                                local += reach(next[m], depth + 1);
+                    }
+                }
+            }
+            found += local;
+        };
+        for (int t = 0; t < pool.threadCount(); t++)
+            pool.submit(search);
+        pool.wait();
+
+        frontier = found.load();
+        reached += frontier;
+        if (onLevel)
+            onLevel({depth + 1, frontier, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), backward});
+    }
+
+    // Same layout as PruneTable::pack: entry i in the low nibble of byte i / 2 when i is even
+    packed.assign(PruneTable::byteSize(size), 0);
+    for (uint64_t i = 0; i < (size + 1) / 2; i++) {
+        const uint32_t word = words[i >> 2].load(std::memory_order_relaxed);
+        packed[i] = uint8_t(word >> (8 * (i & 3)));
+    }
+    if (size & 1)
+        packed[size / 2] &= 0xF;
+    return true;
+}
+
+bool PatternDatabase::open(const std::string& path, const char* name, uint64_t states, std::string& error) {
+    std::unique_ptr<TableFile> mapped(new TableFile());
+    if (!mapped->open(path, error))
+        return false;
+    const void* data = mapped->section(name, PruneTable::byteSize(states));
+    if (!data) {
+        error = path + " has no valid " + name + " table";
+        return false;
+    }
+    distances = PruneTable(static_cast<const uint8_t*>(data));
+    file = std::move(mapped);
+    return true;
+}
+
+bool PatternDatabase::save(const std::string& path, const PatternSpace& space, const std::vector<uint8_t>& packed, std::string& error) {
+    return TableFile::write(path, {{space.name(), packed.data(), packed.size()}}, error);
+}
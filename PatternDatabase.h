@@ -0,0 +1,103 @@
+#ifndef PATTERNDATABASE_H
+#define PATTERNDATABASE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "CubeState.h"
+#include "PruneTable.h"
+#include "TableFile.h"
+
+// Pattern databases: exact distances to solved for one part of the cube (the corners, six of
+// the edges), too big to generate at startup the way SolverTables does, so they are built
+// offline by TableTool and mapped from a table file.
+//
+// A space numbers the states of the part 0 to size() - 1 and gives the neighbours of a state
+// under the 18 CubeState moves, the face turns of RubiksCube::rotateFace. Its move tables are
+// derived from CubeState::applyMove, so the database agrees with the rest of the solver.
+class PatternSpace {
+public:
+    virtual ~PatternSpace() = default;
+    virtual const char* name() const = 0; // section name in the table file
+    virtual uint64_t size() const = 0;
+    virtual uint64_t goal() const = 0;
+    // The state reached from index by every move, in move order
+    virtual void neighbours(uint64_t index, uint64_t (&next)[NUM_MOVES]) const = 0;
+    virtual uint64_t index(const CubeState& state) const = 0;
+};
+
+// Corner permutation and twist: 8! * 3^7 = 88179840 states, at most 11 moves from solved
+class CornerSpace : public PatternSpace {
+public:
+    static constexpr const char* NAME = "corner_pdb";
+    static const uint64_t SIZE = uint64_t(40320) * 2187;
+
+    CornerSpace();
+    const char* name() const override { return NAME; }
+    uint64_t size() const override { return SIZE; }
+    uint64_t goal() const override { return 0; }
+    void neighbours(uint64_t index, uint64_t (&next)[NUM_MOVES]) const override;
+    uint64_t index(const CubeState& state) const override;
+
+private:
+    std::vector<uint16_t> permMoves, twistMoves;
+};
+
+// Slots and flips of the edges UR, UF, UL, UB, DR and DF: 12!/6! * 2^6 = 42577920 states
+class EdgeSpace : public PatternSpace {
+public:
+    static constexpr const char* NAME = "edge6_pdb";
+    static const int TRACKED = 6;
+    static const uint64_t PLACEMENTS = 12 * 11 * 10 * 9 * 8 * 7;
+    static const uint64_t SIZE = PLACEMENTS << TRACKED;
+
+    EdgeSpace();
+    const char* name() const override { return NAME; }
+    uint64_t size() const override { return SIZE; }
+    uint64_t goal() const override { return 0; }
+    void neighbours(uint64_t index, uint64_t (&next)[NUM_MOVES]) const override;
+    uint64_t index(const CubeState& state) const override;
+
+private:
+    std::vector<uint32_t> placementMoves;
+    std::vector<uint8_t> flipMasks; // tracked edges whose flip a move toggles, bit per edge
+};
+
+// One finished level of buildPatternDatabase
+struct PatternLevel {
+    int depth;
+    uint64_t states;   // reached at this depth
+    double seconds;
+    bool backward;     // searched from the unreached states
+};
+
+// Breadth-first distances from space.goal(), by levels. Each level is split into chunks that
+// threads take in turn (0 = one per hardware thread) and distances live in an atomic nibble
+// table, 15 for not reached yet. Early levels expand the frontier; once most states are reached,
+// a level instead checks every unreached state for a neighbour on the frontier, which touches
+// far fewer entries. The result only depends on the space, so builds are reproducible whatever
+// the thread count. Distances are packed like PruneTable; false if one does not fit a nibble.
+bool buildPatternDatabase(const PatternSpace& space, int threads, std::vector<uint8_t>& packed,
+                          const std::function<void(const PatternLevel&)>& onLevel = nullptr);
+
+// A generated database mapped from its table file
+class PatternDatabase {
+public:
+    static constexpr const char* CORNER_PATH = "res/tables/corners.pdb";
+    static constexpr const char* EDGE_PATH = "res/tables/edges.pdb";
+
+    // name and size of the space it was built for, such as CornerSpace::NAME and CornerSpace::SIZE
+    bool open(const std::string& path, const char* name, uint64_t states, std::string& error);
+    static bool save(const std::string& path, const PatternSpace& space, const std::vector<uint8_t>& packed, std::string& error);
+
+    bool isOpen() const { return file != nullptr; }
+    const PruneTable& table() const { return distances; }
+
+private:
+    std::unique_ptr<TableFile> file;
+    PruneTable distances;
+};
+
+#endif // PATTERNDATABASE_H
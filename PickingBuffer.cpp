@@ -0,0 +1,107 @@
+#include "PickingBuffer.h"
+#include <Debugger.h>
+#include <cstring>
+
+PickingBuffer::PickingBuffer(CubeRenderer& renderer, Shader& idShader)
+    : renderer(renderer), shader(idShader) {
+    GLint program = 0;
+    shader.Bind();
+    GLCall(glGetIntegerv(GL_CURRENT_PROGRAM, &program));
+    viewProjectionLocation = glGetUniformLocation(program, "u_VP");
+
+    GLCall(glGenFramebuffers(1, &framebuffer));
+    GLCall(glGenRenderbuffers(1, &idRenderbuffer));
+    GLCall(glGenRenderbuffers(1, &depthRenderbuffer));
+    GLCall(glGenBuffers(BUFFERS, pixelBuffers));
+    for (int i = 0; i < BUFFERS; i++) {
+        GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[i]));
+        GLCall(glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(GLint), nullptr, GL_STREAM_READ));
+    }
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+}
+
+PickingBuffer::~PickingBuffer() {
+    for (int i = 0; i < BUFFERS; i++)
+        if (fences[i])
+            glDeleteSync(fences[i]);
+    GLCall(glDeleteBuffers(BUFFERS, pixelBuffers));
+    GLCall(glDeleteRenderbuffers(1, &idRenderbuffer));
+    GLCall(glDeleteRenderbuffers(1, &depthRenderbuffer));
+    GLCall(glDeleteFramebuffers(1, &framebuffer));
+}
+
+void PickingBuffer::resize(int newWidth, int newHeight) {
+    width = newWidth;
+    height = newHeight;
+    GLCall(glBindRenderbuffer(GL_RENDERBUFFER, idRenderbuffer));
+    GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_R32I, width, height));
+    GLCall(glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer));
+    GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height));
+    GLCall(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+    GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, idRenderbuffer));
+    GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer));
+}
+
+void PickingBuffer::request(const RubiksCube& cube, const glm::mat4& viewProjection, int viewportWidth, int viewportHeight, int x, int y) {
+    if (x < 0 || y < 0 || x >= viewportWidth || y >= viewportHeight)
+        return;
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+    if (viewportWidth != width || viewportHeight != height)
+        resize(viewportWidth, viewportHeight);
+
+    // Only the clicked pixel is cleared, rasterised and read
+    GLint viewport[4];
+    GLCall(glGetIntegerv(GL_VIEWPORT, viewport));
+    GLCall(glViewport(0, 0, width, height));
+    GLCall(glEnable(GL_SCISSOR_TEST));
+    GLCall(glScissor(x, y, 1, 1));
+    const GLint noCube[4] = {NO_CUBE, 0, 0, 0};
+    const GLfloat farthest = 1.0f;
+    GLCall(glClearBufferiv(GL_COLOR, 0, noCube));
+    GLCall(glClearBufferfv(GL_DEPTH, 0, &farthest));
+    renderer.drawWith(shader, viewProjectionLocation, cube, viewProjection);
+
+    // The copy into the pixel buffer is queued like the draw; the fence marks when it is done
+    latest = (latest + 1) % BUFFERS;
+    GLCall(glReadBuffer(GL_COLOR_ATTACHMENT0));
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[latest]));
+    GLCall(glReadPixels(x, y, 1, 1, GL_RED_INTEGER, GL_INT, nullptr));
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    fences[latest] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    GLCall(glFlush()); // so the fence is sure to signal without anyone waiting on it
+
+    GLCall(glDisable(GL_SCISSOR_TEST));
+    GLCall(glViewport(viewport[0], viewport[1], viewport[2], viewport[3]));
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+    // An older request still in flight is superseded
+    for (int i = 0; i < BUFFERS; i++) {
+        if (i != latest && fences[i]) {
+            glDeleteSync(fences[i]);
+            fences[i] = nullptr;
+        }
+    }
+}
+
+bool PickingBuffer::poll(int& id) {
+    GLsync& fence = fences[latest];
+    if (!fence)
+        return false;
+    const GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return false;
+    glDeleteSync(fence);
+    fence = nullptr;
+    if (status == GL_WAIT_FAILED)
+        return false;
+
+    id = NO_CUBE;
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[latest]));
+    const void* pixel = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(GLint), GL_MAP_READ_BIT);
+    if (pixel) {
+        std::memcpy(&id, pixel, sizeof(GLint));
+        GLCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+    }
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    return true;
+}
@@ -0,0 +1,47 @@
+#ifndef PICKING_BUFFER_H
+#define PICKING_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <Shader.h>
+#include "CubeRenderer.h"
+#include "RubiksCube.h"
+
+// Mouse picking without stalling the pipeline. A click draws the cubies' ids with picking.shader
+// into an offscreen framebuffer with an integer colour attachment (-1 where there is no cubie),
+// scissored to the clicked pixel, and starts copying that pixel into a pixel buffer object behind
+// a fence. Nothing waits for the GPU: poll, called once a frame, reads the id once the fence has
+// signalled, normally on the next frame. There are two pixel buffers, so a click while the last
+// one is still in flight never writes to a buffer the GPU may be filling; the older one is dropped.
+class PickingBuffer {
+public:
+    static const int NO_CUBE = -1;
+
+    PickingBuffer(CubeRenderer& renderer, Shader& idShader);
+    ~PickingBuffer();
+    PickingBuffer(const PickingBuffer&) = delete;
+    PickingBuffer& operator=(const PickingBuffer&) = delete;
+
+    // Start picking the cubie under (x, y), in pixels from the bottom left of a width x height
+    // viewport; the framebuffer follows the viewport size
+    void request(const RubiksCube& cube, const glm::mat4& viewProjection, int width, int height, int x, int y);
+    // True, with the id or NO_CUBE, once the latest request has been read back; never blocks
+    bool poll(int& id);
+    bool pending() const { return fences[latest] != nullptr; }
+
+private:
+    static const int BUFFERS = 2;
+
+    void resize(int width, int height);
+
+    CubeRenderer& renderer;
+    Shader& shader;
+    GLint viewProjectionLocation = -1;
+    GLuint framebuffer = 0, idRenderbuffer = 0, depthRenderbuffer = 0;
+    GLuint pixelBuffers[BUFFERS] = {};
+    GLsync fences[BUFFERS] = {};
+    int latest = 0; // pixel buffer of the last request
+    int width = 0, height = 0;
+};
+
+#endif // PICKING_BUFFER_H
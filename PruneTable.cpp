@@ -0,0 +1,34 @@
+#include "PruneTable.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+bool PruneTable::pack(const std::vector<uint8_t>& distances, std::vector<uint8_t>& packed) {
+    packed.assign(byteSize(distances.size()), 0);
+    for (size_t i = 0; i < distances.size(); i++) {
+        if (distances[i] > MAX_DISTANCE)
+            return false;
+        packed[i >> 1] |= distances[i] << ((i & 1) << 2);
+    }
+    return true;
+}
+
+void PruneTable::lookup(const uint32_t* indices, int count, uint8_t* distances) const {
+    int i = 0;
+#ifdef __AVX2__
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i nibble = _mm256_set1_epi32(0xF);
+    for (; i + 8 <= count; i += 8) {
+        // Gather the 32-bit word starting at each entry's byte, then shift its nibble down
+        __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+        __m256i words = _mm256_i32gather_epi32(reinterpret_cast<const int*>(data), _mm256_srli_epi32(index, 1), 1);
+        __m256i shift = _mm256_slli_epi32(_mm256_and_si256(index, one), 2);
+        __m256i values = _mm256_and_si256(_mm256_srlv_epi32(words, shift), nibble);
+        __m128i halves = _mm_packus_epi32(_mm256_castsi256_si128(values), _mm256_extracti128_si256(values, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(distances + i), _mm_packus_epi16(halves, halves));
+    }
+#endif
+    for (; i < count; i++)
+        distances[i] = static_cast<uint8_t>((*this)[indices[i]]);
+}
@@ -0,0 +1,34 @@
+#ifndef PRUNETABLE_H
+#define PRUNETABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Read-only distance table packed two entries per byte: entry i is the low nibble of byte i / 2
+// when i is even and the high nibble when it is odd, so distances must be below 16.
+// The table does not own its bytes; they live in a vector or a mapped table file.
+// Buffers carry PADDING extra bytes so the gather in lookup() can read a whole 32-bit word at
+// the last entry.
+class PruneTable {
+public:
+    static const size_t PADDING = 3;
+    static const int MAX_DISTANCE = 15;
+
+    static size_t byteSize(size_t entries) { return (entries + 1) / 2 + PADDING; }
+    // Packs one byte per entry distances; false if any distance does not fit a nibble
+    static bool pack(const std::vector<uint8_t>& distances, std::vector<uint8_t>& packed);
+
+    PruneTable() = default;
+    explicit PruneTable(const uint8_t* data) : data(data) {}
+
+    int operator[](uint32_t index) const { return (data[index >> 1] >> ((index & 1) << 2)) & 0xF; }
+
+    // distances[i] = (*this)[indices[i]], eight entries per AVX2 gather when available
+    void lookup(const uint32_t* indices, int count, uint8_t* distances) const;
+
+private:
+    const uint8_t* data = nullptr;
+};
+
+#endif // PRUNETABLE_H
@@ -0,0 +1,114 @@
+#include "RandomState.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// Fisher-Yates shuffle of 0 .. count - 1; returns the permutation's parity
+template <int count>
+int shuffle(RandomStream& random, int (&perm)[count]) {
+    int parity = 0;
+    for (int i = 0; i < count; i++)
+        perm[i] = i;
+    for (int i = count - 1; i > 0; i--) {
+        const int j = int(random.below(uint32_t(i + 1)));
+        std::swap(perm[i], perm[j]);
+        parity ^= i != j;
+    }
+    return parity;
+}
+
+const size_t CHUNK = 4096; // states per pool task
+
+} // namespace
+
+RandomStream::RandomStream(uint64_t seed, uint64_t stream) {
+    // Hash the seed before the stream goes in, then hash again, so no two pairs share a start
+    uint64_t x = seed;
+    uint64_t mixed = splitmix64(x) ^ stream;
+    x = splitmix64(mixed);
+    for (uint64_t& word : s)
+        word = splitmix64(x);
+}
+
+uint64_t RandomStream::next() {
+    const uint64_t result = rotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+// Lemire's multiply and shift, redrawing the few values that would make it biased
+uint32_t RandomStream::below(uint32_t bound) {
+    uint64_t product = (next() >> 32) * bound;
+    if (uint32_t(product) < bound) {
+        const uint32_t threshold = uint32_t(-bound) % bound;
+        while (uint32_t(product) < threshold)
+            product = (next() >> 32) * bound;
+    }
+    return uint32_t(product >> 32);
+}
+
+CubeState randomState(RandomStream& random) {
+    int cornerPerm[NUM_CORNERS], edgePerm[NUM_EDGES];
+    const int cornerParity = shuffle(random, cornerPerm);
+    if (shuffle(random, edgePerm) != cornerParity)
+        std::swap(edgePerm[NUM_EDGES - 2], edgePerm[NUM_EDGES - 1]); // pairs odd and even shuffles one to one
+
+    CubeState state{0, 0};
+    uint32_t twists = random.below(2187); // 3^7
+    int twistSum = 0;
+    for (int slot = 0; slot < NUM_CORNERS - 1; slot++, twists /= 3) {
+        state.corners |= uint64_t(cornerPerm[slot] | (twists % 3) << 3) << (5 * slot);
+        twistSum += twists % 3;
+    }
+    state.corners |= uint64_t(cornerPerm[NUM_CORNERS - 1] | ((3 - twistSum % 3) % 3) << 3) << (5 * (NUM_CORNERS - 1));
+
+    const uint64_t flips = random.next() >> 53; // 11 bits
+    int flipSum = 0;
+    for (int slot = 0; slot < NUM_EDGES - 1; slot++) {
+        const int flip = int(flips >> slot & 1);
+        state.edges |= uint64_t(edgePerm[slot] | flip << 4) << (5 * slot);
+        flipSum += flip;
+    }
+    state.edges |= uint64_t(edgePerm[NUM_EDGES - 1] | (flipSum & 1) << 4) << (5 * (NUM_EDGES - 1));
+    return state;
+}
+
+CubeState randomState(uint64_t seed, uint64_t index) {
+    RandomStream random(seed, index);
+    return randomState(random);
+}
+
+void randomStates(uint64_t seed, uint64_t first, std::vector<CubeState>& states, WorkStealingPool* pool) {
+    auto fill = [seed, first, &states](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            states[i] = randomState(seed, first + i);
+    };
+    if (!pool) {
+        fill(0, states.size());
+        return;
+    }
+    for (size_t begin = 0; begin < states.size(); begin += CHUNK) {
+        const size_t end = std::min(states.size(), begin + CHUNK);
+        pool->submit([&fill, begin, end] { fill(begin, end); });
+    }
+    pool->wait();
+}
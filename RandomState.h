@@ -0,0 +1,35 @@
+#ifndef RANDOMSTATE_H
+#define RANDOMSTATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CubeState.h"
+
+class WorkStealingPool;
+
+// Seedable random numbers: xoshiro256** started from splitmix64 of the seed and a stream number.
+// Every (seed, stream) pair is its own sequence, so threads can each take a stream and still get
+// the same numbers on every run.
+class RandomStream {
+public:
+    explicit RandomStream(uint64_t seed, uint64_t stream = 0);
+
+    uint64_t next();
+    uint32_t below(uint32_t bound); // uniform in [0, bound), bound > 0
+
+private:
+    uint64_t s[4];
+};
+
+// A uniformly random legal 3x3x3 state, all 43252003274489856000 equally likely: corner and edge
+// permutations of equal parity, any corner twist and edge flip with the last cubie fixing the sum.
+// Centres are not spun.
+CubeState randomState(RandomStream& random);
+// State index of a seed is drawn from stream index, so any range of a corpus can be made on its
+// own, in any order and on any number of threads, and comes out the same
+CubeState randomState(uint64_t seed, uint64_t index);
+// states[i] = randomState(seed, first + i) for the whole vector, spread over the pool when given
+void randomStates(uint64_t seed, uint64_t first, std::vector<CubeState>& states, WorkStealingPool* pool = nullptr);
+
+#endif // RANDOMSTATE_H
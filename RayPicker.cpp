@@ -0,0 +1,174 @@
+#include "RayPicker.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const float INF = std::numeric_limits<float>::infinity();
+const int POSITIVE_FACE[3] = {0, 2, 5}; // right, up, front
+const int NEGATIVE_FACE[3] = {1, 3, 4}; // left, down, back
+
+// Slab test against the box lo to hi: the distance the ray enters it (0 from inside) and the axis
+// of the side it enters through
+bool intersectBox(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& lo, const glm::vec3& hi,
+                  float& entry, int& entryAxis) {
+    float tNear = -INF, tFar = INF;
+    entryAxis = -1;
+    for (int axis = 0; axis < 3; axis++) {
+        if (direction[axis] == 0.0f) {
+            if (origin[axis] < lo[axis] || origin[axis] > hi[axis])
+                return false;
+            continue;
+        }
+        float t0 = (lo[axis] - origin[axis]) / direction[axis];
+        float t1 = (hi[axis] - origin[axis]) / direction[axis];
+        if (t0 > t1)
+            std::swap(t0, t1);
+        if (t0 > tNear) {
+            tNear = t0;
+            entryAxis = axis;
+        }
+        tFar = std::min(tFar, t1);
+    }
+    if (entryAxis < 0 || tNear > tFar || tFar < 0.0f)
+        return false;
+    entry = std::max(tNear, 0.0f);
+    return true;
+}
+
+// Outward normal of the side a ray enters through
+glm::vec3 entryNormal(const glm::vec3& direction, int axis) {
+    glm::vec3 normal(0.0f);
+    normal[axis] = direction[axis] > 0.0f ? -1.0f : 1.0f;
+    return normal;
+}
+
+// The face a side faces, as a direction in the cube's frame
+int faceOf(const glm::vec3& normal) {
+    const glm::vec3 size = glm::abs(normal);
+    const int axis = size.x >= size.y && size.x >= size.z ? 0 : size.y >= size.z ? 1 : 2;
+    return normal[axis] > 0.0f ? POSITIVE_FACE[axis] : NEGATIVE_FACE[axis];
+}
+
+// Walk the grid cells from lo to hi (inclusive) that the ray crosses, nearest first (Amanatides
+// and Woo), to the first one holding a cubie that counts. Cell (x, y, z) spans x to x + 1 ... in
+// grid coordinates, the cube's frame shifted by half the size. The hit's distance and the normal
+// of the side it was entered through, in the frame of the ray.
+template <typename Counts>
+bool walkGrid(const RubiksCube& cube, const int (&lo)[3], const int (&hi)[3], const glm::vec3& origin,
+              const glm::vec3& direction, Counts counts, RayHit& hit, glm::vec3& normal) {
+    const float half = cube.getSize() / 2.0f;
+    float t;
+    int axis;
+    if (!intersectBox(origin, direction, glm::vec3(lo[0], lo[1], lo[2]) - glm::vec3(half),
+                      glm::vec3(hi[0] + 1, hi[1] + 1, hi[2] + 1) - glm::vec3(half), t, axis))
+        return false;
+
+    const glm::vec3 start = origin + direction * t + glm::vec3(half);
+    int cell[3], step[3];
+    float next[3], delta[3];
+    for (int a = 0; a < 3; a++) {
+        cell[a] = std::min(std::max(int(std::floor(start[a])), lo[a]), hi[a]);
+        step[a] = direction[a] > 0.0f ? 1 : -1;
+        delta[a] = direction[a] != 0.0f ? std::abs(1.0f / direction[a]) : INF;
+        const float boundary = float(direction[a] > 0.0f ? cell[a] + 1 : cell[a]);
+        next[a] = direction[a] != 0.0f ? t + (boundary - start[a]) / direction[a] : INF;
+    }
+    const SlotIndex& slots = cube.slotIndex();
+    for (;;) {
+        const int slot = slots.slotOf(cell[0], cell[1], cell[2]);
+        if (slot >= 0 && counts(cell, slots.cubieAt(slot))) {
+            hit.id = slots.cubieAt(slot);
+            hit.distance = t;
+            normal = entryNormal(direction, axis);
+            return true;
+        }
+        axis = next[0] <= next[1] && next[0] <= next[2] ? 0 : next[1] <= next[2] ? 1 : 2;
+        cell[axis] += step[axis];
+        if (cell[axis] < lo[axis] || cell[axis] > hi[axis])
+            return false;
+        t = next[axis];
+        next[axis] += delta[axis];
+    }
+}
+
+} // namespace
+
+Ray pickingRay(const glm::mat4& view, const glm::mat4& projection, int width, int height, double x, double y) {
+    const float ndcX = float(2.0 * x / width - 1.0);
+    const float ndcY = float(1.0 - 2.0 * y / height);
+    const glm::mat4 unproject = glm::inverse(projection * view);
+    glm::vec4 nearPoint = unproject * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    glm::vec4 farPoint = unproject * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+    const glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+    return {origin, glm::normalize(glm::vec3(farPoint) / farPoint.w - origin)};
+}
+
+// Three kinds of cubie: settled ones, found by one walk over the whole grid; the cubies of a layer
+// mid-turn, which turn rigidly with it, found by a walk over that layer with the ray turned back
+// by the layer's angle; and dragged cubies, each tested against its own box.
+bool pickCubie(const RubiksCube& cube, const glm::mat4& model, const Ray& ray, RayHit& hit) {
+    // In the cube's frame cubies are unit boxes; an affine map keeps distances along the ray
+    const glm::mat4 toCube = glm::inverse(model);
+    const glm::vec3 origin = glm::vec3(toCube * glm::vec4(ray.origin, 1.0f));
+    const glm::vec3 direction = glm::vec3(toCube * glm::vec4(ray.direction, 0.0f));
+    const int n = cube.getSize();
+    const std::vector<int> dragged = cube.getDraggedCubies();
+    auto isDragged = [&dragged](int id) { return std::binary_search(dragged.begin(), dragged.end(), id); };
+
+    hit = RayHit();
+    RayHit candidate;
+    glm::vec3 normal;
+    const int all[3] = {n - 1, n - 1, n - 1}, none[3] = {0, 0, 0};
+    auto settled = [&](const int (&cell)[3], int id) {
+        for (int axis = 0; axis < 3; axis++)
+            if (cube.getLayerAngle(axis, cell[axis]) != 0.0f)
+                return false;
+        return !isDragged(id);
+    };
+    if (walkGrid(cube, none, all, origin, direction, settled, candidate, normal)) {
+        hit = candidate;
+        hit.face = faceOf(normal);
+    }
+
+    for (int axis = 0; axis < 3; axis++) {
+        for (int layer = 0; layer < n; layer++) {
+            const float angle = cube.getLayerAngle(axis, layer);
+            if (angle == 0.0f)
+                continue;
+            glm::vec3 axisVector(0.0f);
+            axisVector[axis] = 1.0f;
+            const glm::mat4 turn = glm::rotate(glm::mat4(1.0f), glm::radians(angle), axisVector);
+            const glm::mat4 unturn = glm::transpose(turn);
+            int lo[3] = {0, 0, 0}, hi[3] = {n - 1, n - 1, n - 1};
+            lo[axis] = hi[axis] = layer;
+            auto inLayer = [&](const int (&)[3], int id) { return !isDragged(id); };
+            if (walkGrid(cube, lo, hi, glm::vec3(unturn * glm::vec4(origin, 1.0f)), glm::vec3(unturn * glm::vec4(direction, 0.0f)),
+                         inLayer, candidate, normal) &&
+                (hit.id < 0 || candidate.distance < hit.distance)) {
+                hit = candidate;
+                hit.face = faceOf(glm::vec3(turn * glm::vec4(normal, 0.0f)));
+            }
+        }
+    }
+
+    for (int id : dragged) {
+        const glm::mat4 cubie = cube.cubieMatrix(cube.getCubes()[id]);
+        const glm::mat4 toCubie = glm::inverse(cubie);
+        const glm::vec3 localDirection = glm::vec3(toCubie * glm::vec4(direction, 0.0f));
+        float entry;
+        int axis;
+        if (intersectBox(glm::vec3(toCubie * glm::vec4(origin, 1.0f)), localDirection, glm::vec3(-0.5f), glm::vec3(0.5f), entry, axis) &&
+            (hit.id < 0 || entry < hit.distance)) {
+            hit.id = id;
+            hit.distance = entry;
+            hit.face = faceOf(glm::vec3(cubie * glm::vec4(entryNormal(localDirection, axis), 0.0f)));
+        }
+    }
+    if (hit.id < 0)
+        return false;
+    hit.point = ray.origin + ray.direction * hit.distance;
+    return true;
+}
@@ -0,0 +1,33 @@
+#ifndef RAYPICKER_H
+#define RAYPICKER_H
+
+#include <glm/glm.hpp>
+#include "RubiksCube.h"
+
+// Picking by ray casting on the CPU, with no GL: the cursor is unprojected into a ray and the ray
+// is intersected with the cubies' boxes, the unit cube each cubie's model matrix carries. Settled
+// cubies fill the cells of the N x N x N grid exactly, so the ray walks the grid cell by cell from
+// where it enters the cube and stops at the first cell holding one. A layer mid-turn is the same
+// grid turned, walked with the ray turned back, and only dragged cubies get a box test each. A
+// pick costs O(N) cells per walk rather than a test per cubie.
+
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction; // unit length
+};
+
+// The ray under window position (x, y), in pixels from the top left as GLFW reports the cursor,
+// from the near plane of projection * view
+Ray pickingRay(const glm::mat4& view, const glm::mat4& projection, int width, int height, double x, double y);
+
+struct RayHit {
+    int id = -1;
+    int face = -1;         // side of the cube the hit surface faces, right = 0 ... front = 5 as in SlotIndex
+    float distance = 0.0f; // along the ray
+    glm::vec3 point = glm::vec3(0.0f);
+};
+
+// The nearest cubie the ray hits, with model the cube's model matrix as drawn; false for none
+bool pickCubie(const RubiksCube& cube, const glm::mat4& model, const Ray& ray, RayHit& hit);
+
+#endif // RAYPICKER_H
@@ -1,201 +1,352 @@
 #include "RubiksCube.h"
+#include "Notation.h"
+#include "Orientation.h"
 #include <glm/gtc/matrix_transform.hpp> // For glm::rotate, glm::translate
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
 
 
-// Constructor
-RubiksCube::RubiksCube() {
-    initializeCubes();
+namespace {
+
+int checkedSize(int size) {
+    if (size < SlotIndex::MIN_SIZE || size > RubiksCube::MAX_SIZE)
+        throw std::invalid_argument("RubiksCube: size must be between 2 and " + std::to_string(RubiksCube::MAX_SIZE));
+    return size;
 }
 
-// Initialize all cubes in a 3x3x3 grid
-void RubiksCube::initializeCubes() {
-    for (int x = -1; x <= 1; x++) {
-        for (int y = -1; y <= 1; y++) {
-            for (int z = -1; z <= 1; z++) {
-                Cube cubie;
-                cubie.id = cubes.size();
-                cubie.position = glm::vec3(x, y, z);
-                cubie.initialPosition = cubie.position;
-                cubes.push_back(cubie);
-                if (x == 0 && y == 0 && z == 0)
-                    centerCube = cubie;
-            }
-        }
+} // namespace
+
+CubieChanges::CubieChanges() {
+    static std::atomic<uint64_t> nextSerial{1};
+    cubeSerial = nextSerial.fetch_add(1, std::memory_order_relaxed);
+}
+
+CubieChanges& CubieChanges::operator=(const CubieChanges&) {
+    cubeSerial = CubieChanges().cubeSerial;
+    current = logStart = 1;
+    log.clear();
+    return *this;
+}
+
+// The steps of an animated turn move the same layer again and again: they become one entry, at
+// the latest version
+void CubieChanges::layerChanged(int axis, int layer) {
+    current++;
+    if (!log.empty() && log.back().axis == axis && log.back().index == layer)
+        log.back().version = current;
+    else
+        add(axis, layer);
+}
+
+void CubieChanges::cubieChanged(int id) {
+    current++;
+    add(-1, id);
+}
+
+void CubieChanges::allChanged() {
+    logStart = ++current;
+    log.clear();
+}
+
+void CubieChanges::add(int axis, int index) {
+    if (log.size() >= MAX_LOG) {
+        logStart = current;
+        log.clear();
+        return;
     }
+    log.push_back({current, axis, index});
 }
 
-std::string toStringVec3(const glm::vec3& vec) {
-    std::ostringstream oss;
-    oss << "(" << vec.x << ", " << vec.y << ", " << vec.z << ")";
-    return oss.str();
+// Constructor
+RubiksCube::RubiksCube(int size)
+    : size(checkedSize(size)), slots(size), pendingAngles(3 * size, 0.0f) {
+    initializeCubes();
+    history.clear(slots);
 }
 
-std::vector<int> RubiksCube::findFaceIds(int face){
-    std::vector<int> faceIds; // first id belongs to the center cubie
-    float epsilon = 0.5f;
-    switch (face){ // face: right = 0, left = 1, up = 2, down = 3, back = 4, front = 5
-        case 0: // right, axis x
-            for(const Cube& cubie : cubes){
-                if (cubie.position.x > centerCube.position.x + epsilon){
-                    faceIds.push_back(cubie.id);
-                }
-            }
-            return faceIds;
-        case 1: // left, axis x
-            for(const Cube& cubie : cubes){
-                if (cubie.position.x < centerCube.position.x - epsilon){
-                    faceIds.push_back(cubie.id);
-                }
-            }
-            return faceIds;
-        case 2: // up, axis y
-            for(const Cube& cubie : cubes){
-                if (cubie.position.y > centerCube.position.y + epsilon){
-                    faceIds.push_back(cubie.id);
-                }
-            }
-            return faceIds;
-        case 3: // down, axis y
-            for(const Cube& cubie : cubes){
-                if (cubie.position.y < centerCube.position.y - epsilon){
-                    faceIds.push_back(cubie.id);
-                }
-            }
-            return faceIds;
-        case 4: // back, axis z
-            for(const Cube& cubie : cubes){
-                if (cubie.position.z < centerCube.position.z - epsilon){
-                    faceIds.push_back(cubie.id);
-                }
-            }
-            return faceIds;
-        case 5: // front, axis z
-            for(const Cube& cubie : cubes){
-                if (cubie.position.z > centerCube.position.z + epsilon){
-                    faceIds.push_back(cubie.id);
-                }
-            }
-            return faceIds;
-        default:
-            std::cerr << "Error: RubikCube - invalid face choice" << std::endl;
-            return {};
+// Initialize the surface cubes of the grid, each in its own slot
+void RubiksCube::initializeCubes() {
+    cubes.reset(slots.slotCount());
+    const float half = (size - 1) / 2.0f;
+    centres.resize(slots.slotCount());
+    for (int slot = 0; slot < slots.slotCount(); slot++) {
+        const short* p = slots.position(slot);
+        centres[slot] = glm::vec4(p[0] - half, p[1] - half, p[2] - half, 1.0f);
     }
 }
 
-bool isFraction(glm::vec3 vector){
-    const float epsilon = 1e-1f;// Small threshold for floating-point precision
-    float fracPartX = vector.x - std::floor(vector.x);
-    float fracPartY = vector.y - std::floor(vector.y);
-    float fracPartZ = vector.z - std::floor(vector.z);
-    
-    return (std::abs(fracPartX) > epsilon && std::abs(fracPartX - 1.0f) > epsilon) ||
-           (std::abs(fracPartY) > epsilon && std::abs(fracPartY - 1.0f) > epsilon) ||
-           (std::abs(fracPartZ) > epsilon && std::abs(fracPartZ - 1.0f) > epsilon);
-}
-
-void RubiksCube::updateLocks(int rotatedFace, glm::vec3 axis, std::vector<int> &faceIds){
-    glm::vec3 l1 = cubes[faceIds[0]].position;
-    glm::vec3 l2 = cubes[faceIds[1]].position;
-    if (isFraction(l1) || isFraction(l2)){ // locks axis
-            std::cout << toStringVec3(l1) << std::endl;std::cout << toStringVec3(l2) << std::endl;
-            std::cout << "fall 1" << std::endl;
-            locks= glm::vec3(1.0f)- axis;
+// Record that a layer turned by angle degrees; once it is back on the grid its cubies settle into new slots
+// and orientations. Until then the turn is only the pending angle, which cubieMatrix applies.
+// Turns about one axis never change which cubies belong to the layers on that axis, so a layer that is
+// mid-turn still reports the right cubies (turns about the other axes are locked meanwhile).
+void RubiksCube::advanceLayer(int axis, int layer, float angle) {
+    const float epsilon = 1e-3f;
+    float& pending = pendingAngles[axis * size + layer];
+    const bool wasSettled = pending == 0.0f;
+    changes.layerChanged(axis, layer);
+    pending += angle;
+    float quarterTurns = std::round(pending / 90.0f);
+    if (std::abs(pending - quarterTurns * 90.0f) < epsilon) {
+        int q = static_cast<int>(quarterTurns) & 3;
+        if (q != 0) {
+            slots.turn(axis, layer, q);
+            cubes.turnLayer(slots.layerCubies(axis, layer), axis, q);
+        }
+        pending = 0.0f;
     }
-    else{ // check if can release lock - {0,1} {2,3} {4,5}
-        int twinFace = -1;
-        if(rotatedFace % 2 == 0)
-            twinFace = rotatedFace + 1;  
-        else
-            twinFace = rotatedFace - 1;
-        std::vector<int> twinFaceIds = findFaceIds(twinFace); 
-        glm::vec3 twinl1 = cubes[twinFaceIds[0]].position;
-        glm::vec3 twinl2 = cubes[twinFaceIds[1]].position;
-        if (!isFraction(twinl1) && !isFraction(twinl2)){ // release locks axis
-            locks = glm::vec3(0.0f);
+    unsettledLayers[axis] += (pending == 0.0f ? 0 : 1) - (wasSettled ? 0 : 1);
+    updateLocks();
+}
+
+// While any layer is off the grid only its axis can turn
+void RubiksCube::updateLocks() {
+    locks = glm::vec3(0.0f);
+    for (int axis = 0; axis < 3; axis++) {
+        if (unsettledLayers[axis] > 0) {
+            locks = glm::vec3(1.0f);
+            locks[axis] = 0.0f;
         }
     }
 }
 
 // Rotate a face by applying a transformation to the cubes in that face
 void RubiksCube::rotateFace(int face, glm::vec3 axis, float angle) { // face: right = 0, left =1, up =2, down = 3, back = 4, front = 5
-    float isLocked = glm::dot(axis,locks);
-    std::cout << "isLocked: " << (isLocked==1) << std::endl;
-    if(isLocked == 0){
-        std::vector<int> faceIds = findFaceIds(face);
-        glm::mat4 rotationMatrix = glm::rotate(glm::mat4(1.0f), glm::radians(angle), axis);
-        for (int id : faceIds) {
-            glm::vec4 newPosition = rotationMatrix * glm::vec4(cubes[id].position, 1.0f);
-            cubes[id].position = glm::vec3(newPosition);
-            cubes[id].rotationMatrix = rotationMatrix * cubes[id].rotationMatrix;
-            cubes[id].transformations.push_back({axis, angle});
-        }
-        // lock/unlock axises if needed
-        updateLocks(face, axis, faceIds);
-    }
+    rotateLayer(face / 2, slots.faceLayer(face), axis[face / 2] < 0.0f ? -angle : angle);
+}
+
+void RubiksCube::rotateLayer(int axis, int layer, float angle) {
+    if (turnCubies(axis, layer, angle))
+        recordTurn(axis, layer, angle);
+}
+
+bool RubiksCube::turnCubies(int axis, int layer, float angle) {
+    glm::vec3 axisVector(0.0f);
+    axisVector[axis] = 1.0f;
+    float isLocked = glm::dot(axisVector, locks);
+    if(isLocked != 0)
+        return false;
+    advanceLayer(axis, layer, angle);
+    return true;
+}
+
+// Only turns in whole 45 degree steps are recorded; the keyboard, the solver and mixing never make others
+void RubiksCube::recordTurn(int axis, int layer, float angle) {
+    float eighths = angle / 45.0f;
+    if (std::abs(eighths - std::round(eighths)) < 1e-3f)
+        history.record(axis, layer, static_cast<int>(std::round(eighths)));
 }
 
-void RubiksCube::remoteCubeFaceRotation(int face, glm::vec3 rotationAxis, float degree, float updateDegree) {
-    std::vector<int> faceIds = findFaceIds(face);
+void RubiksCube::remoteLayerRotation(int axis, int layer, float degree, float updateDegree) {
     // Update transformation only once
-    if(updateDegree != 0.0f){
-        for (int id : faceIds)
-            cubes[id].transformations.push_back({rotationAxis, updateDegree});
-            updateLocks(face, rotationAxis, faceIds);
+    if(updateDegree != 0.0f)
+        recordTurn(axis, layer, updateDegree);
+    advanceLayer(axis, layer, degree);
+}
+
+bool RubiksCube::undoMove() {
+    MoveLog::Turn turn;
+    if (!history.undo(turn))
+        return false;
+    if (!turnCubies(MoveLog::turnAxis(turn), MoveLog::turnLayer(turn), -45.0f * MoveLog::turnEighths(turn))) {
+        history.redo(turn); // another axis is mid-turn
+        return false;
+    }
+    return true;
+}
+
+bool RubiksCube::redoMove() {
+    MoveLog::Turn turn;
+    if (!history.redo(turn))
+        return false;
+    if (!turnCubies(MoveLog::turnAxis(turn), MoveLog::turnLayer(turn), 45.0f * MoveLog::turnEighths(turn))) {
+        history.undo(turn);
+        return false;
     }
-        
-    glm::mat4 rotationMatrix = glm::rotate(glm::mat4(1.0f), glm::radians(degree), rotationAxis);
-    for (int id : faceIds) {
-        glm::vec4 newPosition = rotationMatrix * glm::vec4(cubes[id].position, 1.0f);
-        cubes[id].position = glm::vec3(newPosition);
-        cubes[id].rotationMatrix = rotationMatrix * cubes[id].rotationMatrix;
+    return true;
+}
+
+std::vector<Transformation> RubiksCube::cubieHistory(int id) const {
+    std::vector<Transformation> transformations;
+    for (MoveLog::Turn turn : history.cubieTurns(id)) {
+        glm::vec3 axis(0.0f);
+        axis[MoveLog::turnAxis(turn)] = 1.0f;
+        transformations.push_back({axis, 45.0f * MoveLog::turnEighths(turn)});
     }
+    return transformations;
 }
 
 // Reset the Rubik's Cube to its initial state
 void RubiksCube::resetCube() {
-    for (Cube& cubie : cubes) {
-        cubie.position = cubie.initialPosition;
-        cubie.rotationMatrix = glm::mat4(1.0f);
-        cubie.transformations.clear();
-    }
+    cubes.reset(slots.slotCount());
+    drags.clear();
+    slots.reset();
+    history.clear(slots);
+    std::fill(pendingAngles.begin(), pendingAngles.end(), 0.0f);
+    std::fill(std::begin(unsettledLayers), std::end(unsettledLayers), 0);
+    updateLocks();
+    changes.allChanged();
+}
+
+void RubiksCube::applyMove(int move) {
+    glm::vec3 axis(0.0f);
+    axis[moveAxis(move)] = 1.0f;
+    int quarterTurns = moveQuarterTurns(move);
+    rotateFace(moveFace(move), axis, quarterTurns == 3 ? -90.0f : 90.0f * quarterTurns);
+}
+
+bool RubiksCube::applyMoves(std::string_view notation) {
+    MoveParser parser;
+    auto turn = [this](int move) { applyMove(move); };
+    return parser.feed(notation, turn) && parser.finish(turn);
 }
 
 // Getter for the cubes
-std::vector<Cube>& RubiksCube::getCubes() {
+const CubieArrays& RubiksCube::getCubes() const {
     return cubes;
 }
 
-void RubiksCube::mixCube() {
-    // Seed the random number generator
-    std::srand(static_cast<unsigned>(std::time(nullptr)));
-    int numTransformations = std::rand() % 30 + 20; // Random number between 1 and 20
-
-    // Define the valid rotation axis for each face
-    const std::vector<std::pair<int, glm::vec3>> faceAxisMap = {
-        {0, glm::vec3(1.0f, 0.0f, 0.0f)}, // RIGHT face -> X-axis
-        {1, glm::vec3(1.0f, 0.0f, 0.0f)}, // LEFT face -> X-axis
-        {2, glm::vec3(0.0f, 1.0f, 0.0f)}, // UP face -> Y-axis
-        {3, glm::vec3(0.0f, 1.0f, 0.0f)}, // DOWN face -> Y-axis
-        {4, glm::vec3(0.0f, 0.0f, 1.0f)}, // BACK face -> Z-axis
-        {5, glm::vec3(0.0f, 0.0f, 1.0f)}  // FRONT face -> Z-axis
-    };
-
-    // Apply random transformations
-    for (int i = 0; i < numTransformations; ++i) {
-        // Randomly select a face
-        int randomIndex = std::rand() % faceAxisMap.size();
-        int randomFace = faceAxisMap[randomIndex].first;
-        glm::vec3 rotationAxis = faceAxisMap[randomIndex].second;
-
-        // Randomly select an angle (90, -90, 180 degrees)
-        float randomAngle = 90.0f * (1 + std::rand() % 2); // 90 or 180 degrees
-        if (std::rand() % 2 == 0) {
-            randomAngle = -randomAngle; // Randomize the direction of rotation
+// A cubie keeps the place the last turn that moved it left it in, so it is still in that turn's
+// layer, and a layer's cubies as of now cover every cubie its logged turns moved
+bool RubiksCube::getChangedCubies(uint64_t since, std::vector<int>& ids) const {
+    ids.clear();
+    return changes.since(since, [&](const CubieChanges::Change& change) {
+        if (change.axis < 0) {
+            ids.push_back(change.index);
+            return;
+        }
+        for (int id : slots.layerCubies(change.axis, change.index))
+            ids.push_back(id);
+    });
+}
+
+std::vector<int> RubiksCube::getDraggedCubies() const {
+    std::vector<int> ids;
+    for (const auto& drag : drags)
+        ids.push_back(drag.first);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+void RubiksCube::place(const Cube& cubie, glm::vec3& position, glm::mat4& rotation) const {
+    const short* p = slots.position(cubie.slot);
+    position = glm::vec3(centres[cubie.slot]);
+    rotation = orientationMatrix(cubie.orientation);
+    for (int axis = 0; axis < 3; axis++) {
+        float angle = unsettledLayers[axis] > 0 ? pendingAngles[axis * size + p[axis]] : 0.0f;
+        if (angle != 0.0f) {
+            glm::vec3 axisVector(0.0f);
+            axisVector[axis] = 1.0f;
+            glm::mat4 turn = glm::rotate(glm::mat4(1.0f), glm::radians(angle), axisVector);
+            position = glm::vec3(turn * glm::vec4(position, 1.0f));
+            rotation = turn * rotation;
         }
-        // Rotate the selected face
-        rotateFace(randomFace, rotationAxis, randomAngle);
+    }
+    auto drag = drags.find(cubie.id);
+    if (drag != drags.end()) {
+        position += drag->second.translation;
+        rotation = drag->second.rotation * rotation;
     }
 }
 
+glm::mat4 RubiksCube::cubieMatrix(const Cube& cubie) const {
+    glm::vec3 position;
+    glm::mat4 rotation;
+    place(cubie, position, rotation);
+    return glm::translate(glm::mat4(1.0f), position) * rotation;
+}
+
+glm::vec3 RubiksCube::cubiePosition(const Cube& cubie) const {
+    glm::vec3 position;
+    glm::mat4 rotation;
+    place(cubie, position, rotation);
+    return position;
+}
+
+void RubiksCube::cubieMatrices(const glm::mat4& parent, glm::mat4* out) const {
+    cubes.transform(parent, centres.data(), out);
+    const int turningAxes = (unsettledLayers[0] > 0) + (unsettledLayers[1] > 0) + (unsettledLayers[2] > 0);
+    for (int axis = 0; axis < 3; axis++) {
+        if (unsettledLayers[axis] == 0)
+            continue;
+        glm::vec3 axisVector(0.0f);
+        axisVector[axis] = 1.0f;
+        for (int layer = 0; layer < size; layer++) {
+            const float angle = pendingAngles[axis * size + layer];
+            if (angle == 0.0f)
+                continue;
+            const SlotIndex::Layer cubies = slots.layerCubies(axis, layer);
+            if (turningAxes == 1) {
+                cubes.transform(glm::rotate(parent, glm::radians(angle), axisVector), centres.data(), cubies, out);
+            } else {
+                // Remote turns are not locked, so cubies can be in turning layers of two axes
+                for (int id : cubies)
+                    out[id] = parent * cubieMatrix(cubes[id]);
+            }
+        }
+    }
+    for (const auto& drag : drags)
+        out[drag.first] = parent * cubieMatrix(cubes[drag.first]);
+}
+
+void RubiksCube::dragCubie(int id, const glm::mat4& rotation, const glm::vec3& translation) {
+    Drag& drag = drags[id];
+    drag.rotation = rotation * drag.rotation;
+    drag.translation += translation;
+    changes.cubieChanged(id);
+}
+
+bool RubiksCube::getState(CubeState& state) const {
+    const bool settled = unsettledLayers[0] == 0 && unsettledLayers[1] == 0 && unsettledLayers[2] == 0;
+    return size == 3 && settled && CubeState::fromCubes(cubes, state);
+}
+
+bool RubiksCube::setState(const CubeState& state) {
+    if (size != 3)
+        return false;
+    state.toCubes(cubes);
+    for (const Cube& cubie : cubes)
+        slots.setCubie(cubie.slot, cubie.id);
+    drags.clear();
+    std::fill(pendingAngles.begin(), pendingAngles.end(), 0.0f);
+    std::fill(std::begin(unsettledLayers), std::end(unsettledLayers), 0);
+    updateLocks();
+    history.clear(slots);
+    changes.allChanged();
+    return true;
+}
+
+std::vector<MoveLog::Turn> RubiksCube::mixCube(uint64_t seed, const ScramblePolicy& policy) {
+    RandomStream random(seed);
+    return mixCube(random, policy);
+}
+
+std::vector<MoveLog::Turn> RubiksCube::mixCube(RandomStream& random, const ScramblePolicy& policy) {
+    const int minTurns = std::max(0, policy.minTurns);
+    const int count = minTurns + int(random.below(uint32_t(std::max(minTurns, policy.maxTurns) - minTurns + 1)));
+    // The middle layer of an odd cube stays put, so the centres do too
+    const uint32_t layers = uint32_t(size % 2 == 1 ? size - 1 : size);
+    std::vector<MoveLog::Turn> turns;
+    int lastAxis = -1, lastLayer = -1;
+    for (int i = 0; i < count; i++) {
+        int axis, layer;
+        do {
+            axis = int(random.below(3));
+            layer = int(random.below(layers));
+            if (size % 2 == 1 && layer >= size / 2)
+                layer++;
+        } while (policy.avoidRepeats && axis == lastAxis && layer == lastLayer);
+        static const int EIGHTHS[3] = {2, 4, -2}; // 90, 180 or -90 degrees
+        const int eighths = EIGHTHS[random.below(3)];
+        if (!turnCubies(axis, layer, 45.0f * eighths))
+            continue;
+        history.record(axis, layer, eighths);
+        turns.push_back(MoveLog::encode(axis, layer, eighths));
+        lastAxis = axis;
+        lastLayer = layer;
+    }
+    return turns;
+}
 
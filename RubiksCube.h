@@ -2,8 +2,18 @@
 #define RUBIKSCUBE_H
 
 #include <vector>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
 #include <glm/glm.hpp>
 #include <sstream>
+#include <string_view>
+#include "CubeState.h"
+#include "CubieArrays.h"
+#include "SlotIndex.h"
+#include "MoveLog.h"
+#include "RandomState.h"
 
 // Define the Transformation structure
 struct Transformation {
@@ -11,62 +21,143 @@ struct Transformation {
     float rotationAngle;    // Total angle rotated
 };
 
-// Define the Cube structure
-struct Cube {
-    int id;
-    glm::vec3 position;
-    glm::vec3 initialPosition;
-    glm::mat4 rotationMatrix = glm::mat4(1.0f);
-    std::vector<Transformation> transformations; // Record transformations
+// How many turns mixCube makes: a uniformly random count from minTurns to maxTurns
+struct ScramblePolicy {
+    int minTurns = 20;
+    int maxTurns = 49;
+    bool avoidRepeats = true; // never the same layer twice in a row, where the turns would merge
+};
+
+// What moved since a given version, for caches of cubie matrices such as CubeRenderer's. Every
+// change (a turn step, a drag, a reset) makes a new version and logs what it moved: a layer,
+// which the steps of one turn share, or a single cubie. A long log is dropped, which counts as
+// every cubie changed. Serials are unique per process and a copy gets a new one, so a cache keyed
+// by serial and version never takes one cube, or a copy, for another.
+class CubieChanges {
+public:
+    static const size_t MAX_LOG = 256;
+
+    struct Change {
+        uint64_t version;
+        int axis;  // of the turned layer index, -1 when index is a cubie
+        int index;
+    };
+
+    CubieChanges();
+    CubieChanges(const CubieChanges&) : CubieChanges() {}
+    CubieChanges& operator=(const CubieChanges&);
 
-    std::string toString() const {
-        std::ostringstream oss;
-        oss << "Cube ID: " << id << "\n";
-        oss << "Position: (" << position.x << ", " << position.y << ", " << position.z << ")\n";
-        oss << "Initial Position: (" << initialPosition.x << ", " << initialPosition.y << ", " << initialPosition.z << ")\n";
-        // Output rotation matrix as 4x4 matrix
-        oss << "Rotation Matrix:\n";
-        for (int i = 0; i < 4; ++i) {
-            oss << "  ";
-            for (int j = 0; j < 4; ++j) {
-                oss << rotationMatrix[i][j] << " ";
-            }
-            oss << "\n";
-        }
-        oss << "Transformations:\n";
-        if (transformations.empty()) {
-            oss << "  None\n";
-        } else {
-            for (const auto& transformation : transformations) {
-                oss << "  - Axis: (" << transformation.rotationAxis.x << ", "
-                    << transformation.rotationAxis.y << ", " << transformation.rotationAxis.z << ")"
-                    << ", Angle: " << transformation.rotationAngle << " degrees\n";
-            }
-        }
-        return oss.str();
-    }   
+    uint64_t serial() const { return cubeSerial; }
+    uint64_t version() const { return current; }
+    // visit(change) for every change after version after, oldest first; false when everything
+    // may have changed, after being older than the log
+    template <typename Visit>
+    bool since(uint64_t after, Visit visit) const {
+        if (after < logStart)
+            return false;
+        auto first = std::partition_point(log.begin(), log.end(), [after](const Change& change) { return change.version <= after; });
+        for (auto change = first; change != log.end(); ++change)
+            visit(*change);
+        return true;
+    }
 
+    void layerChanged(int axis, int layer);
+    void cubieChanged(int id);
+    void allChanged();
+
+private:
+    void add(int axis, int index);
+
+    uint64_t cubeSerial;
+    uint64_t current = 1;
+    uint64_t logStart = 1; // the log has every change after this version
+    std::vector<Change> log;
 };
 
 // Define the RubiksCube class
+// An N x N x N cube (size 2 and up) of which only the surface cubies are stored; cube ids are the
+// SlotIndex slot numbers of the solved cube. Layers along an axis are numbered 0 to size - 1 from
+// the negative side, so left, down and back are layer 0. CubeState, the solvers and notation
+// only know the 3x3x3.
 class RubiksCube {
 private:
-    std::vector<Cube> cubes; // All small cubes
-    Cube centerCube;
+    int size;
+    CubieArrays cubes; // All small cubes on the surface, by id
+    AlignedVector<glm::vec4> centres; // of every slot, about the cube's centre, w = 1
+    SlotIndex slots; // which cubie sits in which grid slot, as of the last settled turn of each layer
+    std::vector<float> pendingAngles; // rotation of each layer (axis * size + layer) since its cubies last settled on the grid
+    int unsettledLayers[3] = {}; // layers per axis with a pending rotation
+    MoveLog history; // turns in 45 degree steps, for undo/redo and per-cubie history
+    CubieChanges changes;
+    // Cubies moved by hand on screen, a rotation about their centre and a translation; only drawn
+    struct Drag {
+        glm::mat4 rotation = glm::mat4(1.0f);
+        glm::vec3 translation = glm::vec3(0.0f);
+    };
+    std::unordered_map<int, Drag> drags;
     void initializeCubes(); 
-    std::vector<int> findFaceIds(int face);
-    void updateLocks(int rotatedFace, glm::vec3 axis,  std::vector<int> &faceIds);
-    void rotateFace(int face, glm::vec3 axis, float angle);
+    bool turnCubies(int axis, int layer, float angle); // false when the axis is locked
+    void recordTurn(int axis, int layer, float angle);
+    void advanceLayer(int axis, int layer, float angle);
+    void updateLocks();
+    void place(const Cube& cubie, glm::vec3& position, glm::mat4& rotation) const;
     
 public:
     glm::vec3 locks = glm::vec3(0.0f);
-    RubiksCube(); // Constructor
+    static const int MAX_SIZE = MoveLog::MAX_LAYERS;
+    explicit RubiksCube(int size = 3); // Constructor, throws std::invalid_argument for a size out of range
 
-    void mixCube();
+    int getSize() const { return size; }
+    int faceLayer(int face) const { return slots.faceLayer(face); } // the outer layer a face turns
+    void rotateFace(int face, glm::vec3 axis, float angle);
+    // Turn one layer angle degrees about the positive x (0), y (1) or z (2) axis, in time
+    // proportional to the layer's cubie count
+    void rotateLayer(int axis, int layer, float angle);
+    void applyMove(int move); // CubeState move index, turned at once
+    // Turns every move of a sequence in standard notation (see Notation.h); false on a bad token,
+    // in which case the moves before it have been applied
+    bool applyMoves(std::string_view notation);
+    // Revert or make again the last recorded turn (at once); false when there is none
+    bool undoMove();
+    bool redoMove();
+    const MoveLog& moveLog() const { return history; }
+    // The recorded turns that moved a cubie, oldest first, rebuilt from the move log
+    std::vector<Transformation> cubieHistory(int id) const;
+    // Random quarter and half turns of every layer but the middle one of an odd cube, at once and
+    // recorded. The same seed and policy always make the same turns, which are returned so a
+    // scramble can be logged and replayed; a turn of a locked axis is skipped and not returned.
+    // Give each thread its own stream (RandomState.h) to scramble several cubes at once.
+    std::vector<MoveLog::Turn> mixCube(uint64_t seed, const ScramblePolicy& policy = ScramblePolicy());
+    std::vector<MoveLog::Turn> mixCube(RandomStream& random, const ScramblePolicy& policy = ScramblePolicy());
     void resetCube();
-    std::vector<Cube>& getCubes(); // Getter for cubes
-    // void rotateFaceAnimated(face, rotationAxis, correctionAngle);
-    void remoteCubeFaceRotation(int face, glm::vec3 rotationAxis, float degree, float updateDegree);
+    const CubieArrays& getCubes() const; // Getter for cubes
+    // Which cubie sits in which grid slot; the cubies of a layer mid-turn and dragged cubies have
+    // left theirs, carried by the layer's angle and by their drag
+    const SlotIndex& slotIndex() const { return slots; }
+    // Degrees about the positive axis a layer has turned since its cubies last settled
+    float getLayerAngle(int axis, int layer) const { return pendingAngles[axis * size + layer]; }
+    std::vector<int> getDraggedCubies() const; // ascending ids
+    // Model matrix of a cubie about the cube's centre, and its centre, with any turn in progress
+    // and hand drag applied
+    glm::mat4 cubieMatrix(const Cube& cubie) const;
+    glm::vec3 cubiePosition(const Cube& cubie) const;
+    // parent * cubieMatrix of every cubie into out[id], out holding getCubes().size() matrices.
+    // The settled cubies go through CubieArrays::transform, then each layer mid-turn is done again
+    // with its turn, so the cost per cubie is a table lookup and a few vector operations.
+    void cubieMatrices(const glm::mat4& parent, glm::mat4* out) const;
+    // Move a cubie on screen: rotation about its centre and translation, on top of earlier drags.
+    // The model and the solver ignore drags; resetCube and setState clear them.
+    void dragCubie(int id, const glm::mat4& rotation, const glm::vec3& translation);
+    // Which cubieMatrix results changed since a version, so matrices can be cached and updated
+    const CubieChanges& getChanges() const { return changes; }
+    // Ids of the cubies moved after version since of getChanges, possibly repeated and a few more
+    // (a turned layer's cubies as of now); false when they may all have moved
+    bool getChangedCubies(uint64_t since, std::vector<int>& ids) const;
+    bool getState(CubeState& state) const; // False while a layer is mid-turn, or for another size than 3
+    bool setState(const CubeState& state); // False for another size than 3
+    // One step of an animated turn, degree about the positive axis and not checked against the
+    // locks; updateDegree, when not 0, is the whole turn, recorded once
+    void remoteLayerRotation(int axis, int layer, float degree, float updateDegree);
 };
 
 #endif // RUBIKSCUBE_H
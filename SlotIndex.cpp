@@ -0,0 +1,118 @@
+#include "SlotIndex.h"
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+
+// Lexicographic surface slot of (x, y, z): whole outer x slabs hold size^2 slots, the inner ones
+// only the 4(size-1) around their edge
+int surfaceSlot(int size, int x, int y, int z) {
+    const int last = size - 1;
+    const int outerY = y == 0 || y == last, outerZ = z == 0 || z == last;
+    if (x == 0)
+        return y * size + z;
+    int slot = size * size + (x - 1) * 4 * last;
+    if (x == last)
+        return slot + y * size + z;
+    if (!outerY && !outerZ)
+        return -1;
+    if (y > 0)
+        slot += size + (y - 1) * 2;
+    if (outerY)
+        return slot + z;
+    return slot + (z == 0 ? 0 : 1);
+}
+
+} // namespace
+
+std::shared_ptr<const SlotIndex::Geometry> SlotIndex::geometry(int size) {
+    static std::mutex mutex;
+    static std::map<int, std::shared_ptr<const Geometry>> built;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const Geometry>& cached = built[size];
+    if (cached)
+        return cached;
+
+    auto shape = std::make_shared<Geometry>();
+    shape->size = size;
+    for (int x = 0; x < size; x++)
+        for (int y = 0; y < size; y++)
+            for (int z = 0; z < size; z++)
+                if (surfaceSlot(size, x, y, z) >= 0)
+                    shape->positions.insert(shape->positions.end(), {short(x), short(y), short(z)});
+    for (int axis = 0; axis < 3; axis++) {
+        const int a = (axis + 1) % 3, b = (axis + 2) % 3;
+        for (int layer = 0; layer < size; layer++) {
+            shape->layerRings.push_back(int(shape->rings.size()));
+            const bool outer = layer == 0 || layer == size - 1;
+            // Rings by their half width h, in doubled coordinates so even sizes stay integral: a
+            // side is h slots from (-h, -h), and the other three sides are it turned 90, 180 and
+            // 270 degrees, (p[a], p[b]) -> (-p[b], p[a]) like SlotIndex::turn
+            for (int h = size - 1; h >= 0 && (outer || h == size - 1); h -= 2) {
+                Ring ring = {int(shape->layerSlots.size()), h == 0 ? 1 : 4 * h, h};
+                for (int side = 0; side < 4 && (side == 0 || h > 0); side++) {
+                    for (int i = 0; i < (h == 0 ? 1 : h); i++) {
+                        int p[3];
+                        p[axis] = 2 * layer - (size - 1);
+                        p[a] = -h + 2 * i;
+                        p[b] = -h;
+                        for (int q = 0; q < side; q++) {
+                            int next = p[a];
+                            p[a] = -p[b];
+                            p[b] = next;
+                        }
+                        const int half = size - 1;
+                        shape->layerSlots.push_back(surfaceSlot(size, (p[0] + half) / 2, (p[1] + half) / 2, (p[2] + half) / 2));
+                    }
+                }
+                shape->rings.push_back(ring);
+            }
+        }
+    }
+    shape->layerRings.push_back(int(shape->rings.size()));
+    cached = shape;
+    return cached;
+}
+
+SlotIndex::SlotIndex(int size) {
+    if (size < MIN_SIZE)
+        throw std::invalid_argument("SlotIndex: a cube needs at least 2 layers");
+    shape = geometry(size);
+    const int inner = size - 2;
+    cubies.resize(size * size * size - inner * inner * inner);
+    moved.resize(4 * (size - 1));
+    reset();
+}
+
+void SlotIndex::reset() {
+    for (int slot = 0; slot < slotCount(); slot++)
+        cubies[slot] = slot;
+}
+
+int SlotIndex::slotOf(int x, int y, int z) const {
+    return surfaceSlot(size(), x, y, z);
+}
+
+SlotIndex::Layer SlotIndex::layerCubies(int axis, int layer) const {
+    const int id = axis * size() + layer;
+    const Ring& first = shape->rings[shape->layerRings[id]];
+    const Ring& last = shape->rings[shape->layerRings[id + 1] - 1];
+    return Layer(&shape->layerSlots[first.begin], last.begin + last.length - first.begin, cubies.data());
+}
+
+void SlotIndex::turn(int axis, int layer, int quarterTurns) {
+    const int q = quarterTurns & 3;
+    if (q == 0)
+        return;
+    const int id = axis * size() + layer;
+    for (int r = shape->layerRings[id]; r < shape->layerRings[id + 1]; r++) {
+        const Ring& ring = shape->rings[r];
+        const int* slots = &shape->layerSlots[ring.begin];
+        for (int k = 0; k < ring.length; k++)
+            moved[k] = cubies[slots[k]];
+        const int shift = q * ring.step;
+        for (int k = 0; k < ring.length; k++)
+            cubies[slots[(k + shift) % ring.length]] = moved[k];
+    }
+}
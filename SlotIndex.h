@@ -0,0 +1,90 @@
+#ifndef SLOTINDEX_H
+#define SLOTINDEX_H
+
+#include <memory>
+#include <vector>
+
+// Slot -> cubie index for the surface of an N x N x N cube. Only surface slots exist: they are
+// the grid positions (x, y, z), each 0 to N-1, in lexicographic order with the hidden interior
+// skipped. That is the numbering RubiksCube uses for cube ids, so the identity index is the solved
+// cube; on the 3x3x3 it is every position but the core.
+//
+// A layer is every slot with the same coordinate along axis 0 (x), 1 (y) or 2 (z), numbered 0 to
+// N-1 from the negative side. Layers are stored as concentric rings, each listed so that moving
+// a quarter of the way round is a 90 degree turn about the positive axis: an outer layer is all
+// its rings, an inner layer only the outermost one. A turn rotates those rings and touches nothing
+// else, so it costs the layer's cubie count (N^2 or 4(N-1)) rather than the cube's.
+class SlotIndex {
+public:
+    static const int MIN_SIZE = 2;
+
+    // Ids of the cubies in one layer, ring by ring, a corner first; valid until the index changes
+    class Layer {
+    public:
+        class iterator {
+        public:
+            iterator(const int* slot, const int* cubies) : slot(slot), cubies(cubies) {}
+            int operator*() const { return cubies[*slot]; }
+            iterator& operator++() { slot++; return *this; }
+            bool operator!=(const iterator& other) const { return slot != other.slot; }
+        private:
+            const int* slot;
+            const int* cubies;
+        };
+
+        Layer(const int* slots, int count, const int* cubies) : slots(slots), count(count), cubies(cubies) {}
+        int size() const { return count; }
+        int operator[](int i) const { return cubies[slots[i]]; }
+        int slotAt(int i) const { return slots[i]; }
+        iterator begin() const { return iterator(slots, cubies); }
+        iterator end() const { return iterator(slots + count, cubies); }
+
+    private:
+        const int* slots;
+        int count;
+        const int* cubies;
+    };
+
+    explicit SlotIndex(int size = 3);
+    void reset();
+
+    int size() const { return shape->size; }
+    int slotCount() const { return int(cubies.size()); }
+    // Slot of grid position (x, y, z), -1 for the interior, and back
+    int slotOf(int x, int y, int z) const;
+    const short* position(int slot) const { return &shape->positions[3 * slot]; }
+
+    int cubieAt(int slot) const { return cubies[slot]; }
+    void setCubie(int slot, int id) { cubies[slot] = id; }
+
+    // Layer of a face (right = 0, left = 1, up = 2, down = 3, back = 4, front = 5) along its axis
+    int faceLayer(int face) const { return face == 0 || face == 2 || face == 5 ? size() - 1 : 0; }
+    Layer layerCubies(int axis, int layer) const;
+    Layer faceCubies(int face) const { return layerCubies(face / 2, faceLayer(face)); }
+
+    // Move the layer's cubies quarterTurns * 90 degrees about the positive axis
+    void turn(int axis, int layer, int quarterTurns);
+    void turnFace(int face, int quarterTurns) { turn(face / 2, faceLayer(face), quarterTurns); }
+
+private:
+    struct Ring {
+        int begin;  // into layerSlots
+        int length;
+        int step;   // slots per quarter turn
+    };
+    // The rings of every size in use are built once and shared by all indexes of that size
+    struct Geometry {
+        int size;
+        std::vector<int> layerSlots; // every layer's rings back to back, axis * size + layer order
+        std::vector<Ring> rings;
+        std::vector<int> layerRings; // first ring of each layer, and one past the last
+        std::vector<short> positions; // x, y, z of every slot
+    };
+    static std::shared_ptr<const Geometry> geometry(int size);
+
+    std::shared_ptr<const Geometry> shape;
+    std::vector<int> cubies;
+    std::vector<int> moved; // scratch for turn, as long as the longest ring
+};
+
+#endif // SLOTINDEX_H
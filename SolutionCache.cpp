@@ -0,0 +1,158 @@
+#include "SolutionCache.h"
+#include "CubeSymmetry.h"
+#include "RubiksCube.h"
+
+namespace {
+
+uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+const int MOVES_PER_WORD = 12;
+
+} // namespace
+
+SolutionCache::SolutionCache(size_t budgetBytes, int shardCount) {
+    if (shardCount < 1)
+        shardCount = 1;
+    size_t shardsRounded = 1;
+    while (shardsRounded * 2 <= size_t(shardCount))
+        shardsRounded *= 2;
+    bucketCount = shardsRounded;
+    while (bucketCount * 2 * sizeof(Bucket) <= budgetBytes)
+        bucketCount *= 2;
+    buckets.reset(new Bucket[bucketCount]);
+    for (size_t i = 0; i < shardsRounded; i++)
+        shards.push_back(std::make_unique<Shard>());
+}
+
+uint64_t SolutionCache::key(const CubeState& representative) {
+    uint64_t hash = mix(mix(representative.edges) ^ representative.corners);
+    return hash != 0 ? hash : 1;
+}
+
+bool SolutionCache::find(uint64_t key, const CubeState& representative, std::vector<int>& moves) {
+    const size_t index = key & (bucketCount - 1);
+    Shard& shard = *shards[index & (shards.size() - 1)];
+    Bucket& bucket = buckets[index];
+    for (int way = 0; way < WAYS; way++) {
+        const Entry& entry = bucket.ways[way];
+        uint64_t words[2], corners, edges;
+        for (;;) {
+            const uint64_t before = entry.version.load(std::memory_order_acquire);
+            if ((before & 1) || entry.key.load(std::memory_order_relaxed) != key)
+                break; // being written counts as a miss; the writer is about to make it current
+            words[0] = entry.moves[0].load(std::memory_order_relaxed);
+            words[1] = entry.moves[1].load(std::memory_order_relaxed);
+            corners = entry.corners.load(std::memory_order_relaxed);
+            edges = entry.edges.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (entry.version.load(std::memory_order_relaxed) != before)
+                continue;
+            if (corners != representative.corners || edges != representative.edges)
+                break; // another class with the same hash
+
+            moves.clear();
+            for (int i = 0; i < 2 * MOVES_PER_WORD; i++) {
+                const int code = int(words[i / MOVES_PER_WORD] >> (5 * (i % MOVES_PER_WORD)) & 31);
+                if (code == 0)
+                    break;
+                moves.push_back(code - 1);
+            }
+            const uint8_t bit = uint8_t(1 << way);
+            if (!(bucket.referenced.load(std::memory_order_relaxed) & bit))
+                bucket.referenced.fetch_or(bit, std::memory_order_relaxed);
+            shard.hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void SolutionCache::store(uint64_t key, const CubeState& representative, const std::vector<int>& moves) {
+    if (moves.size() > size_t(MAX_SOLUTION_LENGTH))
+        return;
+    uint64_t words[2] = {0, 0};
+    for (size_t i = 0; i < moves.size(); i++)
+        words[i / MOVES_PER_WORD] |= uint64_t(moves[i] + 1) << (5 * (i % MOVES_PER_WORD));
+
+    const size_t index = key & (bucketCount - 1);
+    Shard& shard = *shards[index & (shards.size() - 1)];
+    Bucket& bucket = buckets[index];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // The same representative again or an empty way first, then CLOCK: skip (and clear) referenced ways
+    int way = -1;
+    for (int w = 0; w < WAYS && way < 0; w++)
+        if (bucket.ways[w].key.load(std::memory_order_relaxed) == key &&
+            bucket.ways[w].corners.load(std::memory_order_relaxed) == representative.corners &&
+            bucket.ways[w].edges.load(std::memory_order_relaxed) == representative.edges)
+            way = w;
+    for (int w = 0; w < WAYS && way < 0; w++)
+        if (bucket.ways[w].key.load(std::memory_order_relaxed) == 0)
+            way = w;
+    if (way < 0) {
+        while (bucket.referenced.load(std::memory_order_relaxed) & (1 << bucket.hand)) {
+            bucket.referenced.fetch_and(uint8_t(~(1 << bucket.hand)), std::memory_order_relaxed);
+            bucket.hand = uint8_t((bucket.hand + 1) % WAYS);
+        }
+        way = bucket.hand;
+        bucket.hand = uint8_t((bucket.hand + 1) % WAYS);
+        shard.evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Entry& entry = bucket.ways[way];
+    const uint64_t version = entry.version.load(std::memory_order_relaxed);
+    entry.version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.key.store(key, std::memory_order_relaxed);
+    entry.corners.store(representative.corners, std::memory_order_relaxed);
+    entry.edges.store(representative.edges, std::memory_order_relaxed);
+    entry.moves[0].store(words[0], std::memory_order_relaxed);
+    entry.moves[1].store(words[1], std::memory_order_relaxed);
+    entry.version.store(version + 2, std::memory_order_release);
+    bucket.referenced.fetch_and(uint8_t(~(1 << way)), std::memory_order_relaxed);
+    shard.inserts.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool SolutionCache::lookup(const CubeState& state, std::vector<int>& moves) {
+    const SymmetryReduction reduction = reduceBySymmetry(state);
+    if (!find(key(reduction.representative), reduction.representative, moves))
+        return false;
+    unreduceSolution(reduction, moves);
+    return true;
+}
+
+void SolutionCache::insert(const CubeState& state, const std::vector<int>& moves) {
+    const SymmetryReduction reduction = reduceBySymmetry(state);
+    std::vector<int> reduced = moves;
+    reduceSolution(reduction, reduced);
+    store(key(reduction.representative), reduction.representative, reduced);
+}
+
+bool SolutionCache::lookup(const RubiksCube& cube, std::vector<int>& moves) {
+    CubeState state;
+    return cube.getState(state) && lookup(state, moves);
+}
+
+void SolutionCache::insert(const RubiksCube& cube, const std::vector<int>& moves) {
+    CubeState state;
+    if (cube.getState(state))
+        insert(state, moves);
+}
+
+SolutionCache::Stats SolutionCache::stats() const {
+    Stats total = {0, 0, 0, 0, bucketCount * WAYS};
+    for (const auto& shard : shards) {
+        total.hits += shard->hits.load(std::memory_order_relaxed);
+        total.misses += shard->misses.load(std::memory_order_relaxed);
+        total.inserts += shard->inserts.load(std::memory_order_relaxed);
+        total.evictions += shard->evictions.load(std::memory_order_relaxed);
+    }
+    return total;
+}
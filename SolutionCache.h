@@ -0,0 +1,81 @@
+#ifndef SOLUTIONCACHE_H
+#define SOLUTIONCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "CubeState.h"
+
+class RubiksCube;
+
+// Solutions shared between threads, keyed by a 64-bit hash of the state's symmetry class
+// representative (CubeSymmetry.h). A scramble, its rotations, mirror images and inverse all hit
+// the same entry: the solution is stored for the representative and translated on the way out.
+// The entry also keeps the representative itself, and a hit has to match it, so two classes
+// whose hashes collide never get each other's solution.
+//
+// Lookups take no lock. Every entry is a seqlock, with a version that is odd while the entry is
+// written, so a reader copies the entry and retries if the version moved. Inserts lock the shard
+// the key falls in. Storage is set associative: a key can only live in one bucket of WAYS
+// entries, and a full bucket evicts by CLOCK. A hit sets the entry's reference bit, and the
+// bucket's hand clears bits until it reaches an entry nobody used since it last passed.
+// Every bucket is allocated up front from the memory budget, so the cache never grows past it.
+class SolutionCache {
+public:
+    static const size_t DEFAULT_BUDGET = size_t(64) << 20; // bytes
+    static const int DEFAULT_SHARDS = 64;
+    static const int WAYS = 8;
+    static const int MAX_SOLUTION_LENGTH = 24; // longer solutions are not cached
+
+    struct Stats {
+        long long hits, misses, inserts, evictions;
+        size_t capacity; // entries
+    };
+
+    // The budget is rounded down to a power of two number of buckets, and at least one per shard
+    explicit SolutionCache(size_t budgetBytes = DEFAULT_BUDGET, int shards = DEFAULT_SHARDS);
+
+    SolutionCache(const SolutionCache&) = delete;
+    SolutionCache& operator=(const SolutionCache&) = delete;
+
+    // True and moves that solve state on a hit
+    bool lookup(const CubeState& state, std::vector<int>& moves);
+    void insert(const CubeState& state, const std::vector<int>& moves);
+    // Keyed by the cube's cubies; a lookup misses and an insert does nothing while a face is mid-turn
+    bool lookup(const RubiksCube& cube, std::vector<int>& moves);
+    void insert(const RubiksCube& cube, const std::vector<int>& moves);
+
+    static uint64_t key(const CubeState& representative); // never 0, which marks an empty entry
+
+    Stats stats() const;
+    size_t memoryBytes() const { return bucketCount * sizeof(Bucket); }
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> version{0};
+        std::atomic<uint64_t> key{0};
+        std::atomic<uint64_t> corners{0}, edges{0}; // the representative
+        std::atomic<uint64_t> moves[2] = {}; // move + 1, 5 bits each, 12 to a word, 0 after the last
+    };
+    struct alignas(64) Bucket {
+        Entry ways[WAYS];
+        std::atomic<uint8_t> referenced{0}; // CLOCK bits, one per way
+        uint8_t hand = 0;                   // next way to consider for eviction, under the shard lock
+    };
+    struct alignas(64) Shard {
+        std::mutex mutex; // writers only
+        std::atomic<long long> hits{0}, misses{0}, inserts{0}, evictions{0};
+    };
+
+    bool find(uint64_t key, const CubeState& representative, std::vector<int>& moves);
+    void store(uint64_t key, const CubeState& representative, const std::vector<int>& moves);
+
+    size_t bucketCount;
+    std::unique_ptr<Bucket[]> buckets;
+    std::vector<std::unique_ptr<Shard>> shards;
+};
+
+#endif // SOLUTIONCACHE_H
@@ -0,0 +1,129 @@
+#include "Solver.h"
+#include "RubiksCube.h"
+
+namespace {
+
+const int MAX_DEPTH = 32;
+
+bool isPhase2Move(int move) {
+    return moveFace(move) == 2 || moveFace(move) == 3 || moveQuarterTurns(move) == 2;
+}
+
+struct Search {
+    const SolverTables& tables;
+    const CubeState& start;
+    int maxLength;
+    int moves[MAX_DEPTH];
+    int length = -1;
+
+    int lastFace(int depth) const { return depth > 0 ? moveFace(moves[depth - 1]) : -1; }
+
+    bool phase1(int twist, int flip, int slice, int depth, int togo) {
+        if (togo == 0) {
+            // A phase 1 solution ending in a phase 2 move was already tried one move shorter
+            if (twist != 0 || flip != 0 || slice != SOLVED_SLICE || (depth > 0 && isPhase2Move(moves[depth - 1])))
+                return false;
+            return startPhase2(depth);
+        }
+        // Generate every child first so their bounds come from one batch of table lookups
+        int childMoves[NUM_MOVES], twists[NUM_MOVES], flips[NUM_MOVES], slices[NUM_MOVES];
+        int children = 0;
+        for (int move = 0; move < NUM_MOVES; move++) {
+            if (isRedundantAfter(lastFace(depth), moveFace(move)))
+                continue;
+            childMoves[children] = move;
+            twists[children] = tables.twistMove(twist, move);
+            flips[children] = tables.flipMove(flip, move);
+            slices[children] = tables.sliceMove(slice, move);
+            children++;
+        }
+        uint8_t distances[NUM_MOVES];
+        tables.phase1Distances(twists, flips, slices, children, distances);
+        for (int i = 0; i < children; i++) {
+            if (distances[i] >= togo)
+                continue;
+            moves[depth] = childMoves[i];
+            if (phase1(twists[i], flips[i], slices[i], depth + 1, togo - 1))
+                return true;
+        }
+        return false;
+    }
+
+    bool startPhase2(int depth1) {
+        CubeState state = start;
+        for (int i = 0; i < depth1; i++)
+            state.applyMove(moves[i]);
+        int cornerPerm = cornerPermCoord(state), udEdgePerm = udEdgePermCoord(state), slicePerm = slicePermCoord(state);
+        for (int togo = tables.phase2Distance(cornerPerm, udEdgePerm, slicePerm); depth1 + togo <= maxLength; togo++) {
+            if (phase2(cornerPerm, udEdgePerm, slicePerm, depth1, togo)) {
+                length = depth1 + togo;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool phase2(int cornerPerm, int udEdgePerm, int slicePerm, int depth, int togo) {
+        if (togo == 0)
+            return cornerPerm == 0 && udEdgePerm == 0 && slicePerm == 0;
+        int childMoves[PHASE2_MOVE_COUNT], cornerPerms[PHASE2_MOVE_COUNT], udEdgePerms[PHASE2_MOVE_COUNT], slicePerms[PHASE2_MOVE_COUNT];
+        int children = 0;
+        for (int i = 0; i < PHASE2_MOVE_COUNT; i++) {
+            if (isRedundantAfter(lastFace(depth), moveFace(PHASE2_MOVES[i])))
+                continue;
+            childMoves[children] = PHASE2_MOVES[i];
+            cornerPerms[children] = tables.cornerPermMove(cornerPerm, i);
+            udEdgePerms[children] = tables.udEdgePermMove(udEdgePerm, i);
+            slicePerms[children] = tables.slicePermMove(slicePerm, i);
+            children++;
+        }
+        uint8_t distances[PHASE2_MOVE_COUNT];
+        tables.phase2Distances(cornerPerms, udEdgePerms, slicePerms, children, distances);
+        for (int i = 0; i < children; i++) {
+            if (distances[i] >= togo)
+                continue;
+            moves[depth] = childMoves[i];
+            if (phase2(cornerPerms[i], udEdgePerms[i], slicePerms[i], depth + 1, togo - 1))
+                return true;
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+bool Solver::solve(const CubeState& state, std::vector<int>& moves, int maxLength) const {
+    moves.clear();
+    if (!state.isValid())
+        return false;
+    if (maxLength >= MAX_DEPTH)
+        maxLength = MAX_DEPTH - 1;
+
+    Search search{tables, state, maxLength, {}};
+    int twist = twistCoord(state), flip = flipCoord(state), slice = sliceCoord(state);
+    for (int depth1 = tables.phase1Distance(twist, flip, slice); depth1 <= maxLength; depth1++) {
+        if (search.phase1(twist, flip, slice, 0, depth1)) {
+            moves.assign(search.moves, search.moves + search.length);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Solver::solve(const RubiksCube& cube, std::vector<FaceRotation>& solution, int maxLength) const {
+    solution.clear();
+    CubeState state;
+    std::vector<int> moves;
+    if (!cube.getState(state) || !solve(state, moves, maxLength))
+        return false;
+    for (int move : moves)
+        solution.push_back(toFaceRotation(move));
+    return true;
+}
+
+FaceRotation Solver::toFaceRotation(int move) {
+    glm::vec3 axis(0.0f);
+    axis[moveAxis(move)] = 1.0f;
+    int quarterTurns = moveQuarterTurns(move);
+    return {moveFace(move), axis, quarterTurns == 3 ? -90.0f : 90.0f * quarterTurns};
+}
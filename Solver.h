@@ -0,0 +1,40 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "CubeState.h"
+#include "SolverTables.h"
+
+class RubiksCube;
+
+// One solution step in the vocabulary of RubiksCube::rotateFace
+struct FaceRotation {
+    int face;
+    glm::vec3 axis;
+    float angle;
+};
+
+// Kociemba's two-phase solver. Phase 1 takes the cube into the subgroup <U, D, R2, L2, F2, B2>
+// (corners untwisted, edges unflipped, middle-layer edges in the middle layer) and phase 2 solves
+// it inside that subgroup; both phases are IDA* over SolverTables. Solutions are near-optimal
+// rather than optimal: the first one no longer than maxLength is returned.
+// solve() is const and safe to call from several threads sharing one Solver.
+class Solver {
+public:
+    static const int DEFAULT_MAX_LENGTH = 22;
+
+    explicit Solver(const SolverTables& tables) : tables(tables) {}
+
+    // Moves as CubeState move indices; false if no solution of at most maxLength moves exists
+    bool solve(const CubeState& state, std::vector<int>& moves, int maxLength = DEFAULT_MAX_LENGTH) const;
+    // False as well while a face of the cube is mid-turn
+    bool solve(const RubiksCube& cube, std::vector<FaceRotation>& solution, int maxLength = DEFAULT_MAX_LENGTH) const;
+
+    static FaceRotation toFaceRotation(int move);
+
+private:
+    const SolverTables& tables;
+};
+
+#endif // SOLVER_H
@@ -0,0 +1,178 @@
+#include "SolverTables.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+const uint8_t UNKNOWN = 0xFF;
+
+// next[coordinate * moveCount + m] for every coordinate, by decoding into a CubeState,
+// applying the move and encoding again
+template <typename Set, typename Get>
+std::vector<uint16_t> buildMoveTable(int count, const int* moves, int moveCount, Set set, Get get) {
+    std::vector<uint16_t> table(size_t(count) * moveCount);
+    for (int coordinate = 0; coordinate < count; coordinate++) {
+        CubeState state = CubeState::solved();
+        set(state, coordinate);
+        for (int m = 0; m < moveCount; m++) {
+            CubeState moved = state;
+            moved.applyMove(moves[m]);
+            table[size_t(coordinate) * moveCount + m] = static_cast<uint16_t>(get(moved));
+        }
+    }
+    return table;
+}
+
+// Breadth-first distances from goal over a pair-of-coordinates index, major * minorCount + minor
+std::vector<uint8_t> buildPruneTable(int majorCount, int minorCount, int goal, int moveCount,
+                                     const std::vector<uint16_t>& majorMoves, const std::vector<uint16_t>& minorMoves) {
+    const size_t size = size_t(majorCount) * minorCount;
+    std::vector<uint8_t> table(size, UNKNOWN);
+    table[goal] = 0;
+    size_t filled = 1;
+    for (uint8_t depth = 0; filled < size; depth++) {
+        for (size_t index = 0; index < size; index++) {
+            if (table[index] != depth)
+                continue;
+            size_t major = index / minorCount, minor = index % minorCount;
+            for (int m = 0; m < moveCount; m++) {
+                size_t next = size_t(majorMoves[major * moveCount + m]) * minorCount + minorMoves[minor * moveCount + m];
+                if (table[next] == UNKNOWN) {
+                    table[next] = depth + 1;
+                    filled++;
+                }
+            }
+        }
+    }
+    return table;
+}
+
+} // namespace
+
+const SolverTables::TableInfo SolverTables::TABLES[TABLE_COUNT] = {
+    {"twist_moves", sizeof(uint16_t) * TWIST_COUNT * NUM_MOVES},
+    {"flip_moves", sizeof(uint16_t) * FLIP_COUNT * NUM_MOVES},
+    {"slice_moves", sizeof(uint16_t) * SLICE_COUNT * NUM_MOVES},
+    {"corner_perm_moves", sizeof(uint16_t) * CORNER_PERM_COUNT * PHASE2_MOVE_COUNT},
+    {"ud_edge_perm_moves", sizeof(uint16_t) * UD_EDGE_PERM_COUNT * PHASE2_MOVE_COUNT},
+    {"slice_perm_moves", sizeof(uint16_t) * SLICE_PERM_COUNT * PHASE2_MOVE_COUNT},
+    {"slice_twist_prune", PruneTable::byteSize(size_t(SLICE_COUNT) * TWIST_COUNT)},
+    {"slice_flip_prune", PruneTable::byteSize(size_t(SLICE_COUNT) * FLIP_COUNT)},
+    {"corner_slice_prune", PruneTable::byteSize(size_t(CORNER_PERM_COUNT) * SLICE_PERM_COUNT)},
+    {"edge_slice_prune", PruneTable::byteSize(size_t(UD_EDGE_PERM_COUNT) * SLICE_PERM_COUNT)},
+};
+
+SolverTables::SolverTables() {
+    generate();
+}
+
+SolverTables::SolverTables(const std::string& path) {
+    std::string error;
+    if (!map(path, error)) {
+        std::cerr << "SolverTables: " << error << ", generating the tables instead" << std::endl;
+        generate();
+    }
+}
+
+void SolverTables::generate() {
+    int allMoves[NUM_MOVES];
+    for (int m = 0; m < NUM_MOVES; m++)
+        allMoves[m] = m;
+
+    generatedMoves.resize(SLICE_TWIST_PRUNE);
+    generatedMoves[TWIST_MOVES] = buildMoveTable(TWIST_COUNT, allMoves, NUM_MOVES, setTwistCoord, twistCoord);
+    generatedMoves[FLIP_MOVES] = buildMoveTable(FLIP_COUNT, allMoves, NUM_MOVES, setFlipCoord, flipCoord);
+    generatedMoves[SLICE_MOVES] = buildMoveTable(SLICE_COUNT, allMoves, NUM_MOVES, setSliceCoord, sliceCoord);
+    generatedMoves[CORNER_PERM_MOVES] = buildMoveTable(CORNER_PERM_COUNT, PHASE2_MOVES, PHASE2_MOVE_COUNT, setCornerPermCoord, cornerPermCoord);
+    generatedMoves[UD_EDGE_PERM_MOVES] = buildMoveTable(UD_EDGE_PERM_COUNT, PHASE2_MOVES, PHASE2_MOVE_COUNT, setUdEdgePermCoord, udEdgePermCoord);
+    generatedMoves[SLICE_PERM_MOVES] = buildMoveTable(SLICE_PERM_COUNT, PHASE2_MOVES, PHASE2_MOVE_COUNT, setSlicePermCoord, slicePermCoord);
+
+    const auto& moves = generatedMoves;
+    const std::vector<uint8_t> distances[] = {
+        buildPruneTable(SLICE_COUNT, TWIST_COUNT, SOLVED_SLICE * TWIST_COUNT, NUM_MOVES, moves[SLICE_MOVES], moves[TWIST_MOVES]),
+        buildPruneTable(SLICE_COUNT, FLIP_COUNT, SOLVED_SLICE * FLIP_COUNT, NUM_MOVES, moves[SLICE_MOVES], moves[FLIP_MOVES]),
+        buildPruneTable(CORNER_PERM_COUNT, SLICE_PERM_COUNT, 0, PHASE2_MOVE_COUNT, moves[CORNER_PERM_MOVES], moves[SLICE_PERM_MOVES]),
+        buildPruneTable(UD_EDGE_PERM_COUNT, SLICE_PERM_COUNT, 0, PHASE2_MOVE_COUNT, moves[UD_EDGE_PERM_MOVES], moves[SLICE_PERM_MOVES]),
+    };
+    generatedPrune.resize(TABLE_COUNT - SLICE_TWIST_PRUNE);
+    for (size_t i = 0; i < generatedPrune.size(); i++)
+        if (!PruneTable::pack(distances[i], generatedPrune[i]))
+            throw std::runtime_error(std::string("SolverTables: a ") + TABLES[SLICE_TWIST_PRUNE + i].name + " distance does not fit a nibble");
+
+    for (int id = 0; id < SLICE_TWIST_PRUNE; id++)
+        tableData[id] = generatedMoves[id].data();
+    for (int id = SLICE_TWIST_PRUNE; id < TABLE_COUNT; id++)
+        tableData[id] = generatedPrune[id - SLICE_TWIST_PRUNE].data();
+    bind();
+}
+
+bool SolverTables::map(const std::string& path, std::string& error) {
+    std::unique_ptr<TableFile> mapped(new TableFile());
+    if (!mapped->open(path, error))
+        return false;
+    for (int id = 0; id < TABLE_COUNT; id++) {
+        tableData[id] = mapped->section(TABLES[id].name, TABLES[id].size);
+        if (!tableData[id]) {
+            error = path + " has no valid " + TABLES[id].name + " table";
+            return false;
+        }
+    }
+    file = std::move(mapped);
+    bind();
+    return true;
+}
+
+void SolverTables::bind() {
+    twistMoves = static_cast<const uint16_t*>(tableData[TWIST_MOVES]);
+    flipMoves = static_cast<const uint16_t*>(tableData[FLIP_MOVES]);
+    sliceMoves = static_cast<const uint16_t*>(tableData[SLICE_MOVES]);
+    cornerPermMoves = static_cast<const uint16_t*>(tableData[CORNER_PERM_MOVES]);
+    udEdgePermMoves = static_cast<const uint16_t*>(tableData[UD_EDGE_PERM_MOVES]);
+    slicePermMoves = static_cast<const uint16_t*>(tableData[SLICE_PERM_MOVES]);
+    sliceTwistPrune = PruneTable(static_cast<const uint8_t*>(tableData[SLICE_TWIST_PRUNE]));
+    sliceFlipPrune = PruneTable(static_cast<const uint8_t*>(tableData[SLICE_FLIP_PRUNE]));
+    cornerSlicePrune = PruneTable(static_cast<const uint8_t*>(tableData[CORNER_SLICE_PRUNE]));
+    edgeSlicePrune = PruneTable(static_cast<const uint8_t*>(tableData[EDGE_SLICE_PRUNE]));
+}
+
+bool SolverTables::save(const std::string& path, std::string& error) const {
+    std::vector<TableFile::Input> inputs;
+    for (int id = 0; id < TABLE_COUNT; id++)
+        inputs.push_back({TABLES[id].name, tableData[id], TABLES[id].size});
+    return TableFile::write(path, inputs, error);
+}
+
+int SolverTables::phase1Distance(int twist, int flip, int slice) const {
+    return std::max(sliceTwistDistance(slice, twist), sliceFlipDistance(slice, flip));
+}
+
+int SolverTables::phase2Distance(int cornerPerm, int udEdgePerm, int slicePerm) const {
+    return std::max(cornerSliceDistance(cornerPerm, slicePerm), edgeSliceDistance(udEdgePerm, slicePerm));
+}
+
+void SolverTables::phase1Distances(const int* twist, const int* flip, const int* slice, int count, uint8_t* distances) const {
+    uint32_t twistIndex[MAX_BATCH] = {}, flipIndex[MAX_BATCH] = {};
+    for (int i = 0; i < count; i++) {
+        twistIndex[i] = slice[i] * TWIST_COUNT + twist[i];
+        flipIndex[i] = slice[i] * FLIP_COUNT + flip[i];
+    }
+    uint8_t flipDistances[MAX_BATCH];
+    sliceTwistPrune.lookup(twistIndex, count, distances);
+    sliceFlipPrune.lookup(flipIndex, count, flipDistances);
+    for (int i = 0; i < count; i++)
+        distances[i] = std::max(distances[i], flipDistances[i]);
+}
+
+void SolverTables::phase2Distances(const int* cornerPerm, const int* udEdgePerm, const int* slicePerm, int count, uint8_t* distances) const {
+    uint32_t cornerIndex[MAX_BATCH] = {}, edgeIndex[MAX_BATCH] = {};
+    for (int i = 0; i < count; i++) {
+        cornerIndex[i] = cornerPerm[i] * SLICE_PERM_COUNT + slicePerm[i];
+        edgeIndex[i] = udEdgePerm[i] * SLICE_PERM_COUNT + slicePerm[i];
+    }
+    uint8_t edgeDistances[MAX_BATCH];
+    cornerSlicePrune.lookup(cornerIndex, count, distances);
+    edgeSlicePrune.lookup(edgeIndex, count, edgeDistances);
+    for (int i = 0; i < count; i++)
+        distances[i] = std::max(distances[i], edgeDistances[i]);
+}
@@ -0,0 +1,79 @@
+#ifndef SOLVERTABLES_H
+#define SOLVERTABLES_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "CubeCoordinates.h"
+#include "PruneTable.h"
+#include "TableFile.h"
+
+// Move and pruning tables over the coordinates in CubeCoordinates.h, shared by the solvers.
+// Move tables give the coordinate reached by a move; pruning tables give the exact number of
+// moves needed to solve a pair of coordinates, which is a lower bound for the whole cube, packed
+// two distances per byte (PruneTable).
+// The tables either come from a table file (mapped, so startup costs milliseconds and the
+// pages are shared with other solver processes) or are generated in memory (about a second).
+// They are read-only once constructed.
+class SolverTables {
+public:
+    static constexpr const char* DEFAULT_PATH = "res/tables/solver.tables";
+
+    // Generate every table in memory; throws std::runtime_error if a distance overflows its nibble
+    SolverTables();
+    // Map the tables from path, falling back to generating them if the file is missing or invalid
+    explicit SolverTables(const std::string& path);
+
+    bool isMapped() const { return file != nullptr; }
+    bool save(const std::string& path, std::string& error) const;
+
+    int twistMove(int twist, int move) const { return twistMoves[twist * NUM_MOVES + move]; }
+    int flipMove(int flip, int move) const { return flipMoves[flip * NUM_MOVES + move]; }
+    int sliceMove(int slice, int move) const { return sliceMoves[slice * NUM_MOVES + move]; }
+    // Phase 2 tables are indexed by position in PHASE2_MOVES
+    int cornerPermMove(int perm, int phase2Move) const { return cornerPermMoves[perm * PHASE2_MOVE_COUNT + phase2Move]; }
+    int udEdgePermMove(int perm, int phase2Move) const { return udEdgePermMoves[perm * PHASE2_MOVE_COUNT + phase2Move]; }
+    int slicePermMove(int perm, int phase2Move) const { return slicePermMoves[perm * PHASE2_MOVE_COUNT + phase2Move]; }
+
+    int sliceTwistDistance(int slice, int twist) const { return sliceTwistPrune[slice * TWIST_COUNT + twist]; }
+    int sliceFlipDistance(int slice, int flip) const { return sliceFlipPrune[slice * FLIP_COUNT + flip]; }
+    int cornerSliceDistance(int cornerPerm, int slicePerm) const { return cornerSlicePrune[cornerPerm * SLICE_PERM_COUNT + slicePerm]; }
+    int edgeSliceDistance(int udEdgePerm, int slicePerm) const { return edgeSlicePrune[udEdgePerm * SLICE_PERM_COUNT + slicePerm]; }
+
+    // Lower bounds on the moves left in each phase
+    int phase1Distance(int twist, int flip, int slice) const;
+    int phase2Distance(int cornerPerm, int udEdgePerm, int slicePerm) const;
+
+    // Batch forms for the children of one node, count <= MAX_BATCH: distances[i] is the bound
+    // for (twist[i], flip[i], slice[i]), looked up a block at a time
+    static const int MAX_BATCH = NUM_MOVES;
+    void phase1Distances(const int* twist, const int* flip, const int* slice, int count, uint8_t* distances) const;
+    void phase2Distances(const int* cornerPerm, const int* udEdgePerm, const int* slicePerm, int count, uint8_t* distances) const;
+
+private:
+    enum TableId {
+        TWIST_MOVES, FLIP_MOVES, SLICE_MOVES, CORNER_PERM_MOVES, UD_EDGE_PERM_MOVES, SLICE_PERM_MOVES,
+        SLICE_TWIST_PRUNE, SLICE_FLIP_PRUNE, CORNER_SLICE_PRUNE, EDGE_SLICE_PRUNE, TABLE_COUNT
+    };
+    struct TableInfo {
+        const char* name; // section name in the table file
+        size_t size;      // bytes
+    };
+    static const TableInfo TABLES[TABLE_COUNT];
+
+    void generate();
+    bool map(const std::string& path, std::string& error);
+    void bind(); // point the typed tables at tableData
+
+    const void* tableData[TABLE_COUNT];
+    const uint16_t *twistMoves, *flipMoves, *sliceMoves;
+    const uint16_t *cornerPermMoves, *udEdgePermMoves, *slicePermMoves;
+    PruneTable sliceTwistPrune, sliceFlipPrune, cornerSlicePrune, edgeSlicePrune;
+
+    std::vector<std::vector<uint16_t>> generatedMoves; // backing storage when generated
+    std::vector<std::vector<uint8_t>> generatedPrune;  // packed
+    std::unique_ptr<TableFile> file;                   // backing storage when mapped
+};
+
+#endif // SOLVERTABLES_H
@@ -0,0 +1,194 @@
+#include "TableFile.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[8] = {'R', 'C', 'T', 'A', 'B', 'L', 'E', 'S'};
+const uint64_t ALIGNMENT = 4096;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint64_t headerChecksum;
+    uint64_t fileSize;
+};
+
+static_assert(sizeof(Header) == 32, "table file header must stay 32 bytes");
+static_assert(sizeof(TableFile::Section) == 48, "table file section entry must stay 48 bytes");
+
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+uint64_t headerChecksum(Header header, const TableFile::Section* sections) {
+    header.headerChecksum = 0;
+    return fnv1a(sections, sizeof(TableFile::Section) * header.sectionCount, fnv1a(&header, sizeof(header)));
+}
+
+} // namespace
+
+TableFile::~TableFile() {
+    close();
+}
+
+void TableFile::close() {
+    if (base) {
+#ifndef _WIN32
+        if (mapped)
+            munmap(const_cast<unsigned char*>(base), length);
+        else
+#endif
+            delete[] base;
+    }
+    base = nullptr;
+    length = 0;
+    directory.clear();
+}
+
+bool TableFile::open(const std::string& path, std::string& error) {
+    close();
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header))) {
+        ::close(fd);
+        error = path + " is too short to be a table file";
+        return false;
+    }
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        error = "cannot map " + path;
+        return false;
+    }
+    base = static_cast<const unsigned char*>(mapping);
+    length = static_cast<size_t>(info.st_size);
+    mapped = true;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in || in.tellg() < static_cast<std::streamoff>(sizeof(Header))) {
+        error = "cannot read " + path;
+        return false;
+    }
+    length = static_cast<size_t>(in.tellg());
+    unsigned char* buffer = new unsigned char[length];
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(buffer), length);
+    base = buffer;
+    mapped = false;
+#endif
+
+    Header header;
+    std::memcpy(&header, base, sizeof(header));
+    const Section* sections = reinterpret_cast<const Section*>(base + sizeof(Header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = path + " is not a table file";
+    } else if (header.version != VERSION) {
+        error = path + " has format version " + std::to_string(header.version) + ", expected " + std::to_string(VERSION);
+    } else if (header.fileSize != length || sizeof(Header) + sizeof(Section) * uint64_t(header.sectionCount) > length) {
+        error = path + " is truncated";
+    } else if (headerChecksum(header, sections) != header.headerChecksum) {
+        error = path + " has a corrupt header";
+    } else {
+        directory.assign(sections, sections + header.sectionCount);
+        for (const Section& section : directory) {
+            if (section.offset > length || section.size > length - section.offset) {
+                error = path + " has a section outside the file";
+                close();
+                return false;
+            }
+        }
+        return true;
+    }
+    close();
+    return false;
+}
+
+const void* TableFile::section(const std::string& name, size_t size) const {
+    for (const Section& entry : directory)
+        if (name == std::string(entry.name, strnlen(entry.name, sizeof(entry.name))))
+            return entry.size == size ? base + entry.offset : nullptr;
+    return nullptr;
+}
+
+bool TableFile::verifyData(std::string& error) const {
+    for (const Section& entry : directory) {
+        if (fnv1a(base + entry.offset, entry.size) != entry.checksum) {
+            error = "checksum mismatch in section " + std::string(entry.name, strnlen(entry.name, sizeof(entry.name)));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TableFile::write(const std::string& path, const std::vector<Input>& inputs, std::string& error) {
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.sectionCount = static_cast<uint32_t>(inputs.size());
+
+    std::vector<Section> sections(inputs.size());
+    uint64_t offset = sizeof(Header) + sizeof(Section) * inputs.size();
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (inputs[i].name.size() >= sizeof(sections[i].name)) {
+            error = "section name too long: " + inputs[i].name;
+            return false;
+        }
+        std::memset(sections[i].name, 0, sizeof(sections[i].name));
+        std::memcpy(sections[i].name, inputs[i].name.data(), inputs[i].name.size());
+        offset = (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        sections[i].offset = offset;
+        sections[i].size = inputs[i].size;
+        sections[i].checksum = fnv1a(inputs[i].data, inputs[i].size);
+        offset += inputs[i].size;
+    }
+    header.fileSize = offset;
+    header.headerChecksum = headerChecksum(header, sections.data());
+
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            error = "cannot write " + temporary;
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(sections.data()), sizeof(Section) * sections.size());
+        uint64_t position = sizeof(Header) + sizeof(Section) * sections.size();
+        const char padding[ALIGNMENT] = {};
+        for (size_t i = 0; i < inputs.size(); i++) {
+            out.write(padding, sections[i].offset - position);
+            out.write(static_cast<const char*>(inputs[i].data), inputs[i].size);
+            position = sections[i].offset + inputs[i].size;
+        }
+        if (!out.flush()) {
+            error = "failed writing " + temporary;
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        error = "cannot rename " + temporary + " to " + path;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef TABLEFILE_H
+#define TABLEFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// On-disk container for move/pruning tables.
+//
+// Layout (little endian): a 32 byte header, a directory of 48 byte section entries, then the
+// section data, each section starting on a 4096 byte boundary so it can be used straight from the
+// mapping. The header checksum (FNV-1a over header and directory, with the checksum field zeroed)
+// is always checked on open; the per-section data checksums only by verifyData(), since reading
+// gigabytes at startup is what the format exists to avoid.
+//
+// Files are mapped read-only and shared, so every process using the same file shares one copy in
+// the page cache, and pages are only read from disk when a lookup first touches them.
+class TableFile {
+public:
+    static const uint32_t VERSION = 1;
+
+    struct Section {
+        char name[24];
+        uint64_t offset;
+        uint64_t size;
+        uint64_t checksum;
+    };
+
+    struct Input {
+        std::string name;
+        const void* data;
+        size_t size;
+    };
+
+    TableFile() = default;
+    ~TableFile();
+    TableFile(const TableFile&) = delete;
+    TableFile& operator=(const TableFile&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    // Start of the named section, or nullptr when it is missing or not exactly size bytes
+    const void* section(const std::string& name, size_t size) const;
+    const std::vector<Section>& sections() const { return directory; }
+
+    bool verifyData(std::string& error) const;
+
+    // Written to a temporary file first and renamed, so readers never see a partial file
+    static bool write(const std::string& path, const std::vector<Input>& inputs, std::string& error);
+
+private:
+    const unsigned char* base = nullptr;
+    size_t length = 0;
+    bool mapped = false; // false when the fallback read the file into memory
+    std::vector<Section> directory;
+};
+
+#endif // TABLEFILE_H
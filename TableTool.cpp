@@ -0,0 +1,127 @@
+// Builds and inspects solver table files.
+//   TableTool generate [path]  generate every table and write it to path
+//   TableTool verify [path]    check the header and every section checksum
+//   TableTool info [path]      list the sections of a table file
+//   TableTool pdb corners|edges [path] [threads]
+//                              build a pattern database (PatternDatabase.h) on every core, or on
+//                              threads, reporting each level and the peak memory
+// path defaults to SolverTables::DEFAULT_PATH, or PatternDatabase::CORNER_PATH / EDGE_PATH.
+// Only the solver table sources are linked, no GLFW or GLAD:
+//   TableTool.cpp PatternDatabase.cpp SolverTables.cpp PruneTable.cpp TableFile.cpp
+//   CubeCoordinates.cpp CubeState.cpp CubieArrays.cpp SlotIndex.cpp WorkStealingPool.cpp
+#include "PatternDatabase.h"
+#include "SolverTables.h"
+#include "TableFile.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <sys/resource.h>
+
+namespace {
+
+int generate(const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+    SolverTables tables;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Generated tables in " << seconds << " s" << std::endl;
+
+    std::string error;
+    if (!tables.save(path, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << path << std::endl;
+    return 0;
+}
+
+int verify(const std::string& path) {
+    TableFile file;
+    std::string error;
+    if (!file.open(path, error) || !file.verifyData(error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    std::cout << path << ": OK" << std::endl;
+    return 0;
+}
+
+int info(const std::string& path) {
+    TableFile file;
+    std::string error;
+    if (!file.open(path, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    std::cout << path << ": format version " << TableFile::VERSION << ", " << file.sections().size() << " sections" << std::endl;
+    for (const TableFile::Section& section : file.sections())
+        std::cout << "  " << std::string(section.name, strnlen(section.name, sizeof(section.name)))
+                  << ": " << section.size << " bytes at " << section.offset << std::endl;
+    return 0;
+}
+
+// Peak resident memory of the process so far
+double peakMegabytes() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0; // kilobytes on Linux
+}
+
+int pdb(const std::string& kind, const std::string& pathArgument, int threads) {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<PatternSpace> space;
+    if (kind == "corners")
+        space.reset(new CornerSpace());
+    else if (kind == "edges")
+        space.reset(new EdgeSpace());
+    else {
+        std::cerr << "unknown pattern database " << kind << ", expected corners or edges" << std::endl;
+        return 2;
+    }
+    const std::string path = !pathArgument.empty() ? pathArgument
+                           : kind == "corners" ? PatternDatabase::CORNER_PATH : PatternDatabase::EDGE_PATH;
+    std::cout << "Move tables for " << space->size() << " states in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    std::vector<uint8_t> packed;
+    bool built = buildPatternDatabase(*space, threads, packed, [](const PatternLevel& level) {
+        std::cout << "  depth " << level.depth << ": " << level.states << " states in " << level.seconds << " s ("
+                  << level.states / level.seconds / 1e6 << " M states/s" << (level.backward ? ", backward" : "") << ")" << std::endl;
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!built) {
+        std::cerr << "Search did not finish: a distance does not fit the table" << std::endl;
+        return 1;
+    }
+    std::cout << "Searched " << space->size() << " states in " << seconds << " s (" << space->size() / seconds / 1e6
+              << " M states/s), peak memory " << peakMegabytes() << " MB" << std::endl;
+
+    std::string error;
+    if (!PatternDatabase::save(path, *space, packed, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << path << std::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::string command = argc > 1 ? argv[1] : "";
+    if (command == "pdb" && argc > 2)
+        return pdb(argv[2], argc > 3 ? argv[3] : "", argc > 4 ? std::atoi(argv[4]) : 0);
+    const std::string path = argc > 2 ? argv[2] : SolverTables::DEFAULT_PATH;
+    if (command == "generate")
+        return generate(path);
+    if (command == "verify")
+        return verify(path);
+    if (command == "info")
+        return info(path);
+    std::cerr << "usage: " << argv[0] << " generate|verify|info [path]" << std::endl;
+    std::cerr << "       " << argv[0] << " pdb corners|edges [path] [threads]" << std::endl;
+    return 2;
+}
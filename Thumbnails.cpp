@@ -0,0 +1,314 @@
+// Headless thumbnail renderer. Reads one scramble per line (standard notation, see Notation.h)
+// from a file or stdin, like BatchSolver, and writes an image of the scrambled cube for each,
+// seen from above the front right corner, as <output dir>/<line number>.png (or .ppm).
+// Blank lines and lines starting with # are skipped, lines that do not parse are reported on
+// stderr. With -r, no scrambles are read: the images are that many random cubes of seed -s,
+// uniformly random states (RandomState.h) for size 3 and mixCube scrambles for other sizes.
+//
+//   Thumbnails [-n cube size] [-w image size] [-b images per batch] [-f png|ppm] [-o output dir]
+//              [-j threads] [-r random count] [-s seed] [scramble file]
+//
+// Rendering needs no window or display: an EGL context on Mesa's surfaceless platform (or the
+// default display) draws with basic.shader and the cubie mesh of the window into an
+// OffscreenRenderer, so it runs on a CPU-only box with llvmpipe. While the images of a batch are
+// encoded and written on every core, the next batch is being drawn.
+// Run from the directory holding res/, like the window. Links the engine's Shader, Texture and
+// buffer classes, EGL and the cube model:
+//   Thumbnails.cpp OffscreenRenderer.cpp ImageFile.cpp CubeRenderer.cpp RubiksCube.cpp
+//   CubieArrays.cpp CubeState.cpp SlotIndex.cpp MoveLog.cpp Notation.cpp RandomState.cpp
+//   WorkStealingPool.cpp
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <Debugger.h>
+#include <VertexBuffer.h>
+#include <VertexBufferLayout.h>
+#include <IndexBuffer.h>
+#include <VertexArray.h>
+#include <Shader.h>
+#include <Texture.h>
+#include "CubeGeometry.h"
+#include "CubeRenderer.h"
+#include "ImageFile.h"
+#include "Notation.h"
+#include "OffscreenRenderer.h"
+#include "RandomState.h"
+#include "RubiksCube.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    int cubeSize = 3;
+    int imageSize = 128; // pixels, square
+    int batchSize = 256; // lowered to what one framebuffer holds
+    bool png = true;
+    std::string outputDir = ".";
+    int threads = 0;
+    std::string inputPath; // empty for stdin
+    long long randomCount = 0; // random cubes instead of input when above 0
+    uint64_t seed = 1;
+};
+
+struct Item {
+    long long line;
+    std::string scramble; // empty for a random cube
+    std::string error;    // empty when drawn and written
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-n" && hasValue)
+            options.cubeSize = std::atoi(argv[++i]);
+        else if (arg == "-w" && hasValue)
+            options.imageSize = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "-b" && hasValue)
+            options.batchSize = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "-f" && hasValue && (std::string(argv[i + 1]) == "png" || std::string(argv[i + 1]) == "ppm"))
+            options.png = std::string(argv[++i]) == "png";
+        else if (arg == "-o" && hasValue)
+            options.outputDir = argv[++i];
+        else if (arg == "-j" && hasValue)
+            options.threads = std::atoi(argv[++i]);
+        else if (arg == "-r" && hasValue)
+            options.randomCount = std::max(0LL, std::atoll(argv[++i]));
+        else if (arg == "-s" && hasValue)
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (!arg.empty() && arg[0] != '-' && options.inputPath.empty())
+            options.inputPath = arg;
+        else
+            return false;
+    }
+    return true;
+}
+
+// A 3.3 core context with no surface, current on this thread
+bool createContext(std::string& error) {
+    EGLDisplay display = EGL_NO_DISPLAY;
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+        error = "cannot initialize EGL";
+        return false;
+    }
+    const EGLint configAttributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        error = "no EGL config for desktop OpenGL";
+        return false;
+    }
+    const EGLint contextAttributes[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+                                        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE};
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        error = "cannot create a surfaceless OpenGL 3.3 context";
+        return false;
+    }
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress))) {
+        error = "cannot load OpenGL functions";
+        return false;
+    }
+    return true;
+}
+
+// Fill batch with up to batchSize scrambles
+void readBatch(std::istream& in, long long& lineNumber, size_t batchSize, std::vector<Item>& batch) {
+    size_t count = 0;
+    batch.resize(batchSize);
+    while (count < batchSize && std::getline(in, batch[count].scramble)) {
+        lineNumber++;
+        std::string& scramble = batch[count].scramble;
+        if (!scramble.empty() && scramble.back() == '\r')
+            scramble.pop_back();
+        size_t start = scramble.find_first_not_of(" \t");
+        if (start == std::string::npos || scramble[start] == '#')
+            continue;
+        batch[count++].line = lineNumber;
+    }
+    batch.resize(count);
+}
+
+void randomBatch(long long count, long long& generated, size_t batchSize, std::vector<Item>& batch) {
+    batch.resize(static_cast<size_t>(std::min<long long>(count - generated, batchSize)));
+    for (Item& item : batch) {
+        item.line = ++generated;
+        item.scramble.clear();
+    }
+}
+
+// The cube of an item; false with item.error for a scramble that does not parse
+bool prepare(const Options& options, Item& item, std::vector<int>& moves, RubiksCube& cube) {
+    item.error.clear();
+    cube.resetCube();
+    if (item.scramble.empty()) {
+        if (cube.getSize() == 3) {
+            cube.setState(randomState(options.seed, uint64_t(item.line - 1)));
+        } else {
+            RandomStream random(options.seed, uint64_t(item.line - 1));
+            cube.mixCube(random);
+        }
+        return true;
+    }
+    if (!parseMoves(item.scramble, moves, item.error))
+        return false;
+    for (int move : moves)
+        cube.applyMove(move);
+    return true;
+}
+
+// Above the front right corner, far enough back for the whole cube to fit
+glm::mat4 thumbnailViewProjection(int cubeSize) {
+    const float fov = glm::radians(30.0f);
+    const float radius = 0.5f * std::sqrt(3.0f) * cubeSize;
+    const float distance = 1.05f * radius / std::sin(0.5f * fov);
+    const glm::vec3 eye = CUBE_CENTER + distance * glm::normalize(glm::vec3(1.0f, 1.2f, 1.6f));
+    return glm::perspective(fov, 1.0f, 0.1f, 2.0f * distance) * glm::lookAt(eye, CUBE_CENTER, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " [-n cube size] [-w image size] [-b images per batch] [-f png|ppm]"
+                  << " [-o output dir] [-j threads] [-r random count] [-s seed] [scramble file]" << std::endl;
+        return 2;
+    }
+    std::ifstream file;
+    if (!options.inputPath.empty() && options.randomCount == 0) {
+        file.open(options.inputPath);
+        if (!file) {
+            std::cerr << "cannot open " << options.inputPath << std::endl;
+            return 1;
+        }
+    }
+    std::istream& in = options.inputPath.empty() ? std::cin : file;
+
+    std::string error;
+    if (!createContext(error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    std::cerr << "OpenGL " << glGetString(GL_VERSION) << " on " << glGetString(GL_RENDERER) << std::endl;
+
+    long long written = 0, failed = 0;
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::unique_ptr<RubiksCube> cube;
+        try {
+            cube = std::make_unique<RubiksCube>(options.cubeSize);
+        } catch (const std::invalid_argument& e) {
+            std::cerr << e.what() << std::endl;
+            return 2;
+        }
+
+        /* Same state as the window: blending, depth test, the cubie mesh, texture and shader.
+           Cubies are closed boxes, so their back faces are culled, which halves the fragments */
+        GLCall(glEnable(GL_BLEND));
+        GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+        GLCall(glEnable(GL_DEPTH_TEST));
+        GLCall(glEnable(GL_CULL_FACE));
+        VertexArray va;
+        VertexBuffer vb(cubeVertices, sizeof(cubeVertices));
+        IndexBuffer ib(cubeIndices, sizeof(cubeIndices));
+        VertexBufferLayout layout;
+        layout.Push<float>(3);  // positions
+        layout.Push<float>(3);  // colors
+        layout.Push<float>(2);  // texCoords
+        va.AddBuffer(vb, layout);
+        Texture texture("res/textures/plane.png");
+        texture.Bind();
+        Shader shader("res/shaders/basic.shader");
+
+        CubeRenderer renderer(va, ib, shader);
+        OffscreenRenderer offscreen(renderer, options.imageSize, options.imageSize, options.batchSize);
+        WorkStealingPool pool(options.threads);
+        const glm::mat4 viewProjection = thumbnailViewProjection(options.cubeSize);
+        const char* extension = options.png ? ".png" : ".ppm";
+        std::cerr << offscreen.capacity() << " images of " << offscreen.tileWidth() << "x" << offscreen.tileHeight()
+                  << " per batch, writing on " << pool.threadCount() << " threads" << std::endl;
+
+        long long lineNumber = 0;
+        std::vector<int> moves;
+        auto fetch = [&](std::vector<Item>& batch) {
+            if (options.randomCount > 0)
+                randomBatch(options.randomCount, lineNumber, offscreen.capacity(), batch);
+            else
+                readBatch(in, lineNumber, offscreen.capacity(), batch);
+        };
+        // Items that do not parse take no tile
+        auto render = [&](std::vector<Item>& batch) {
+            offscreen.begin();
+            for (Item& item : batch)
+                if (prepare(options, item, moves, *cube))
+                    offscreen.draw(*cube, viewProjection);
+            offscreen.end();
+        };
+        auto submit = [&](std::vector<Item>& batch, const uint8_t* pixels, int count) {
+            int tile = 0;
+            for (Item& item : batch) {
+                if (!item.error.empty())
+                    continue;
+                if (tile == count) {
+                    item.error = "could not read the image back";
+                    continue;
+                }
+                const uint8_t* image = pixels + offscreen.tileBytes() * tile++;
+                pool.submit([&options, &offscreen, &item, image, extension] {
+                    const std::string path = options.outputDir + "/" + std::to_string(item.line) + extension;
+                    if (options.png)
+                        writePNG(path, image, offscreen.tileWidth(), offscreen.tileHeight(), item.error);
+                    else
+                        writePPM(path, image, offscreen.tileWidth(), offscreen.tileHeight(), item.error);
+                });
+            }
+        };
+
+        start = std::chrono::steady_clock::now();
+        std::vector<Item> current, next;
+        fetch(current);
+        render(current);
+        while (!current.empty()) {
+            int count = 0;
+            const uint8_t* pixels = offscreen.collect(count);
+            submit(current, pixels, count);
+            fetch(next);
+            if (!next.empty())
+                render(next);
+            pool.wait();
+            offscreen.release();
+            for (const Item& item : current) {
+                if (item.error.empty()) {
+                    written++;
+                } else {
+                    std::cerr << item.line << ": " << item.error << '\n';
+                    failed++;
+                }
+            }
+            current.swap(next);
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << written << " images written, " << failed << " failed in " << seconds << " s ("
+              << written / seconds << " images/s)" << std::endl;
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,98 @@
+#include "WorkStealingPool.h"
+
+namespace {
+
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local int currentWorker = -1;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(int threads) {
+    if (threads <= 0)
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (threads <= 0)
+        threads = 1;
+    for (int i = 0; i < threads; i++)
+        queues.push_back(std::make_unique<Queue>());
+    for (int i = 0; i < threads; i++)
+        workers.emplace_back(&WorkStealingPool::run, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+    int queue = currentPool == this ? currentWorker : static_cast<int>(nextQueue++ % queues.size());
+    pending++;
+    {
+        std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+        queues[queue]->tasks.push_back(std::move(task));
+    }
+    // Taking the lock orders the push before a worker's "nothing to do" check
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    wakeWorkers.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    allDone.wait(lock, [this] { return pending.load() == 0; });
+}
+
+bool WorkStealingPool::popLocal(int worker, std::function<void()>& task) {
+    Queue& queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(int thief, std::function<void()>& task) {
+    const int count = static_cast<int>(queues.size());
+    for (int offset = 1; offset < count; offset++) {
+        Queue& queue = *queues[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(int worker) {
+    currentPool = this;
+    currentWorker = worker;
+    std::function<void()> task;
+    while (true) {
+        if (popLocal(worker, task) || steal(worker, task)) {
+            task();
+            task = nullptr;
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping)
+            return;
+        // Re-check under the lock: submit() takes it after pushing, so no wake-up is lost
+        bool queued = false;
+        for (const auto& queue : queues) {
+            std::lock_guard<std::mutex> queueLock(queue->mutex);
+            queued = queued || !queue->tasks.empty();
+        }
+        if (!queued)
+            wakeWorkers.wait(lock);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own task deque. A worker runs its newest task first
+// and, when its deque is empty, steals the oldest task of another worker, so big subtrees queued
+// early get spread across the cores while every worker keeps its own work cache-local.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threads = 0); // 0 = one per hardware thread
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // From a worker the task goes onto that worker's deque, otherwise the deques take turns
+    void submit(std::function<void()> task);
+    // Block until every submitted task (including tasks submitted by tasks) has finished
+    void wait();
+
+    int threadCount() const { return static_cast<int>(workers.size()); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool popLocal(int worker, std::function<void()>& task);
+    bool steal(int thief, std::function<void()>& task);
+    void run(int worker);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<int> pending{0};       // submitted but not finished
+    std::atomic<unsigned> nextQueue{0};
+    std::mutex sleepMutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable allDone;
+    bool stopping = false;
+};
+
+#endif // WORKSTEALINGPOOL_H
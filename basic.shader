@@ -4,17 +4,23 @@
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 color;
 layout(location = 2) in vec2 texCoord;
+layout(location = 3) in mat4 model; // per cubie, takes locations 3 to 6
+layout(location = 7) in int cubeId;  // per cubie
 
 out vec4 v_Color;
 out vec2 v_TexCoord;
+flat out vec4 v_PickingColor;
 
-uniform mat4 u_MVP;
+uniform mat4 u_VP;
 
 void main()
 {
-	gl_Position = u_MVP *  vec4(position.x, position.y, position.z, 1.0);
+	gl_Position = u_VP * model * vec4(position.x, position.y, position.z, 1.0);
 	v_Color = vec4(color.x, color.y, color.z, 1.0);
 	v_TexCoord = texCoord;
+	// Encode cube ID into color, + 1 to avoid (0, 0, 0) black for no cube
+	int pickingId = cubeId + 1;
+	v_PickingColor = vec4(pickingId & 0xFF, (pickingId >> 8) & 0xFF, (pickingId >> 16) & 0xFF, 255) / 255.0;
 }
 
 #shader fragment
@@ -24,6 +30,7 @@ layout(location = 0) out vec4 FragColor;
 
 in vec4 v_Color;
 in vec2 v_TexCoord;
+flat in vec4 v_PickingColor;
 
 uniform vec4 u_Color;
 uniform sampler2D u_Texture;
@@ -31,7 +38,7 @@ uniform bool u_PickingMode;
 
 void main() {
     if (u_PickingMode) {
-        FragColor = u_Color; // Picking color
+        FragColor = v_PickingColor; // Picking color
     } else {
         vec4 texColor = texture(u_Texture, v_TexCoord) * u_Color;
         FragColor = texColor * v_Color;
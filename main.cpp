@@ -11,6 +11,11 @@
 #include <Texture.h>
 #include <../src/Camera.h>
 #include <RubiksCube.h>
+#include <CubeRenderer.h>
+#include <CubeGeometry.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 /* Window size */
@@ -20,59 +25,16 @@ const float FOVdegree = 45.0f;  // Field Of View Angle
 const float near = 0.1f;
 const float far = 100.0f;
 
-/* Shape cubeVertices coordinates with positions, colors, and corrected texCoords */
-float cubeVertices[] = {
-    // positions                     // colors            // texCoords
-    // Front face (Red)
-    -0.5f, -0.5f,  0.5f,    1.0f, 0.0f, 0.0f,    0.0f, 0.0f,  // Bottom-left
-     0.5f, -0.5f,  0.5f,    1.0f, 0.0f, 0.0f,    1.0f, 0.0f,  // Bottom-right
-     0.5f,  0.5f,  0.5f,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f,  // Top-right
-    -0.5f,  0.5f,  0.5f,    1.0f, 0.0f, 0.0f,    0.0f, 1.0f,  // Top-left
-
-    // Back face (Green)
-    -0.5f, -0.5f, -0.5f,    0.0f, 1.0f, 0.0f,    0.0f, 0.0f,  // Bottom-left
-     0.5f, -0.5f, -0.5f,    0.0f, 1.0f, 0.0f,    1.0f, 0.0f,  // Bottom-right
-     0.5f,  0.5f, -0.5f,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f,  // Top-right
-    -0.5f,  0.5f, -0.5f,    0.0f, 1.0f, 0.0f,    0.0f, 1.0f,  // Top-left
-
-    // Left face (Blue)
-    -0.5f, -0.5f, -0.5f,    0.0f, 0.0f, 1.0f,    0.0f, 0.0f,  // Bottom-left
-    -0.5f, -0.5f,  0.5f,    0.0f, 0.0f, 1.0f,    1.0f, 0.0f,  // Bottom-right
-    -0.5f,  0.5f,  0.5f,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f,  // Top-right
-    -0.5f,  0.5f, -0.5f,    0.0f, 0.0f, 1.0f,    0.0f, 1.0f,  // Top-left
-
-    // Right face (Yellow)
-     0.5f, -0.5f, -0.5f,    1.0f, 1.0f, 0.0f,    0.0f, 0.0f,  // Bottom-left
-     0.5f, -0.5f,  0.5f,    1.0f, 1.0f, 0.0f,    1.0f, 0.0f,  // Bottom-right
-     0.5f,  0.5f,  0.5f,    1.0f, 1.0f, 0.0f,    1.0f, 1.0f,  // Top-right
-     0.5f,  0.5f, -0.5f,    1.0f, 1.0f, 0.0f,    0.0f, 1.0f,  // Top-left
-
-    // Bottom face (Cyan)
-    -0.5f, -0.5f, -0.5f,    0.0f, 1.0f, 1.0f,    0.0f, 0.0f,  // Bottom-left
-     0.5f, -0.5f, -0.5f,    0.0f, 1.0f, 1.0f,    1.0f, 0.0f,  // Bottom-right
-     0.5f, -0.5f,  0.5f,    0.0f, 1.0f, 1.0f,    1.0f, 1.0f,  // Top-right
-    -0.5f, -0.5f,  0.5f,    0.0f, 1.0f, 1.0f,    0.0f, 1.0f,  // Top-left
-
-    // Top face (Magenta/Pink)
-    -0.5f,  0.5f, -0.5f,    1.0f, 0.0f, 1.0f,    0.0f, 0.0f,  // Bottom-left
-     0.5f,  0.5f, -0.5f,    1.0f, 0.0f, 1.0f,    1.0f, 0.0f,  // Bottom-right
-     0.5f,  0.5f,  0.5f,    1.0f, 0.0f, 1.0f,    1.0f, 1.0f,  // Top-right
-    -0.5f,  0.5f,  0.5f,    1.0f, 0.0f, 1.0f,    0.0f, 1.0f,  // Top-left
-};
-
-/* Indices for cubeVertices order */
-unsigned int indices[] = {
-    0, 1, 2, 2, 3, 0,       // Front face
-    4, 5, 6, 6, 7, 4,       // Back face
-    8, 9, 10, 10, 11, 8,    // Left face
-    12, 13, 14, 14, 15, 12, // Right face
-    16, 17, 18, 18, 19, 16, // Bottom face
-    20, 21, 22, 22, 23, 20  // Top face
-};
-
-
 int main(int argc, char* argv[])
 {
+    /* Frame-time benchmark: --benchmark [frames] [cube size] renders that many frames of a turning
+       cube in a hidden window without vsync and prints the average frame time, and how much of it
+       the render thread spent in CubeRenderer::draw issuing the frame. It needs no GPU, e.g.
+       LIBGL_ALWAYS_SOFTWARE=1 xvfb-run ./RubiksCube --benchmark 600 17 runs it on Mesa's llvmpipe */
+    bool benchmark = argc > 1 && std::strcmp(argv[1], "--benchmark") == 0;
+    int benchmarkFrames = benchmark && argc > 2 ? std::atoi(argv[2]) : 600;
+    int benchmarkSize = benchmark && argc > 3 ? std::atoi(argv[3]) : 3;
+
     GLFWwindow* window;
     /* Initialize the library */
     if (!glfwInit())
@@ -83,6 +45,8 @@ int main(int argc, char* argv[])
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (benchmark)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
     /* Create a windowed mode window and its OpenGL context */
     window = glfwCreateWindow(width, height, "OpenGL", NULL, NULL);
@@ -99,7 +63,7 @@ int main(int argc, char* argv[])
     gladLoadGL();
 
     /* Control frame rate */
-    glfwSwapInterval(1);
+    glfwSwapInterval(benchmark ? 0 : 1);
 
     /* Print OpenGL version after completing initialization */
     std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
@@ -113,7 +77,7 @@ int main(int argc, char* argv[])
         /* Generate VAO, VBO, EBO and bind them */
         VertexArray va;
         VertexBuffer vb(cubeVertices, sizeof(cubeVertices));
-        IndexBuffer ib(indices, sizeof(indices));
+        IndexBuffer ib(cubeIndices, sizeof(cubeIndices));
 
         VertexBufferLayout layout;
         layout.Push<float>(3);  // positions
@@ -128,6 +92,7 @@ int main(int argc, char* argv[])
         /* Create shaders */
         Shader shader("res/shaders/basic.shader");
         shader.Bind();
+        Shader pickingShader("res/shaders/picking.shader"); // cube ids, for PickingBuffer
 
         /* Unbind all to prevent accidentally modifying them */
         va.Unbind();
@@ -145,44 +110,37 @@ int main(int argc, char* argv[])
         camera.SetPerspective(near, far, FOVdegree);
         RubiksCube rubiksCube;
         camera.SetRubiksCube(&rubiksCube);
-        camera.SetRenderingResources(&va, &ib, &shader);
-        camera.EnableInputs(window);
+        CubeRenderer renderer(va, ib, shader);
+        camera.SetRenderingResources(&va, &ib, &shader, &renderer);
+        PickingBuffer picking(renderer, pickingShader);
+        camera.SetPickingBuffer(&picking);
+
+        if (benchmark) {
+            RubiksCube benchmarkCube(benchmarkSize);
+            glm::mat4 viewProjection = camera.GetProjectionMatrix() * camera.GetViewMatrix();
+            double drawSeconds = 0.0;
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < benchmarkFrames; frame++) {
+                GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+                benchmarkCube.rotateLayer(frame % 3, frame % benchmarkSize, 90.0f);
+                auto drawStart = std::chrono::steady_clock::now();
+                renderer.draw(benchmarkCube, viewProjection);
+                drawSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - drawStart).count();
+                glfwSwapBuffers(window);
+                GLCall(glFinish()); // Count the rendering, not just the command submission
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << benchmarkFrames << " frames of " << benchmarkCube.getCubes().size() << " cubies, 1 draw call each: "
+                      << 1000.0 * seconds / benchmarkFrames << " ms/frame, " << 1000.0 * drawSeconds / benchmarkFrames
+                      << " ms/frame issuing the draw" << std::endl;
+        }
+        else
+            camera.EnableInputs(window);
 
         /* Loop until the user closes the window */
-        while (!glfwWindowShouldClose(window)){
-            /* Set white background color */
-            GLCall(glClearColor(1.0f, 1.0f, 1.0f, 1.0f));
-            /* Render here */
-            GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
-
-            /* Initialize uniform color */
-            glm::vec4 color = glm::vec4(1.0, 1.0f, 1.0f, 1.0f);
-            glm::mat4 view = camera.GetViewMatrix();
-            glm::mat4 proj = camera.GetProjectionMatrix();
-            for (const auto& cube : rubiksCube.getCubes()){
-                glm::mat4 trans = glm::translate(glm::mat4(1.0f), cube.position+glm::vec3(0.0f, 0.0f, -10.0f));
-                glm::mat4 rot = cube.rotationMatrix;
-                glm::mat4 scl = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f)); // No scaling
-
-                /* Initialize the MVP matrices */ 
-                glm::mat4 model = trans * rot * scl;
-                glm::mat4 mvp = proj * view * model;
-        
-                /* Update shaders paramters and draw to the screen */
-                shader.Bind();
-                shader.SetUniformMat4f("u_MVP", mvp);
-                shader.SetUniform1i("u_Texture", 0);
-
-                va.Bind();
-                ib.Bind();
-                GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
-            }
-            /* Update shaders paramters and draw to the screen */
-            shader.SetUniform4f("u_Color", color);
-            /* Swap front and back buffers */
-            glfwSwapBuffers(window);
-            /* Poll for and process events */
-            glfwPollEvents();
+        while (!benchmark && !glfwWindowShouldClose(window)){
+            /* Advance the queued turns, draw, swap and poll; turns never block the loop */
+            camera.render(window);
         }
     }
     glfwTerminate();
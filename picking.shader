@@ -0,0 +1,28 @@
+#shader vertex
+#version 330
+
+layout(location = 0) in vec3 position;
+layout(location = 3) in mat4 model; // per cubie, takes locations 3 to 6
+layout(location = 7) in int cubeId;  // per cubie
+
+flat out int v_CubeId;
+
+uniform mat4 u_VP;
+
+void main()
+{
+	gl_Position = u_VP * model * vec4(position.x, position.y, position.z, 1.0);
+	v_CubeId = cubeId;
+}
+
+#shader fragment
+#version 330
+
+// The id itself into the integer attachment of PickingBuffer, which clears to -1 for no cube
+layout(location = 0) out int FragId;
+
+flat in int v_CubeId;
+
+void main() {
+    FragId = v_CubeId;
+}